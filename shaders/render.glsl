@@ -6,11 +6,18 @@ double M_PI2 = M_PI / 2.0LF;
 double M_E = 2.71828182845904523536LF;
 double M_EHALF = 1.6487212707001281469LF;
 
+#ifdef COMPUTE_KERNEL
+layout(local_size_x = 64) in;
+vec4 fragColor; // stored to computeImage once the pixel is done
+#else
 out vec4 fragColor;
+#endif
 
 uniform float  time;
 uniform dvec2  center;
 uniform double zoom;
+uniform double zoom_mantissa; // zoom = zoom_mantissa * 2^zoom_exponent, for zooms past the range of a double
+uniform int    zoom_exponent;
 uniform float  theta;
 uniform bool   hflip;
 uniform bool   vflip;
@@ -25,12 +32,18 @@ uniform dvec2  mousePos; // position in pixels
 uniform dvec2  mouseCoord; // position in the complex plane
 uniform double julia_zoom;
 uniform int    julia_maxiters;
+uniform dvec2  julia_dc; // the cursor minus the reference point of the main view
 uniform int    ssaa_factor;
 uniform int    transfer_function;
 
 uniform bool   perturbation;
 uniform bool   series_approx;
 uniform bool   cardioid_check;
+uniform bool   periodicity; // catch orbits caught in a cycle, only for bailouts that wait for z to escape
+uniform int    subdivision; // spacing of the lines of pixels this pass computes, 0 computes every pixel
+uniform bool   single_precision; // iterate in floats, set while the pixels are far enough apart for them
+uniform bool   emulated_double; // iterate in float-float instead of doubles, for gpus that are slow at them
+uniform int    batch_size; // iterations run between bailout checks without perturbation, a multiple of 8. 0 checks every one
 
 uniform bool   taa;
 
@@ -71,6 +84,66 @@ layout(std430, binding = 5) readonly buffer reference_orbit {
     dvec2 reference[];
 };
 uniform int reforbit_size;
+uniform int ref_start; // first iteration pixels follow, 1 when the orbit starts at 0 and 0 for julia sets which start at the reference point
+
+struct Waypoint {
+    dvec2 z;
+    int index;
+};
+layout(std430, binding = 8) readonly buffer reference_waypoints {
+    Waypoint waypoints[]; // used instead of reference when the orbit is compressed
+};
+uniform bool  ref_compressed;
+uniform int   num_waypoints;
+uniform dvec2 ref_c; // the reference point, compressed orbits are recomputed as Z^2 + ref_c between waypoints
+
+layout(std430, binding = 6) readonly buffer coefficients {
+    dvec2 coeffs[]; // series approximation coefficients scaled by powers of sa_radius
+};
+uniform int sa_skip; // iteration the series approximation jumps to, 0 if it can't be used
+uniform int sa_terms;
+uniform double sa_radius;
+
+struct BLA {
+    dvec2 A;
+    dvec2 B;
+    double r;
+};
+layout(std430, binding = 7) readonly buffer bla_table {
+    BLA bla[];
+};
+uniform int bla_offsets[32]; // start of each level, followed by the end of the last one
+uniform int bla_levels; // 0 if the table can't be used
+uniform dvec2 ref_offset; // center minus the point the reference orbit was computed for
+uniform dvec2 ref_offset_scaled; // the same divided by 2^zoom_exponent
+uniform bool use_floatexp; // keep the deltas as floatexp, set when the zoom gets too deep for doubles
+
+// where a pixel stopped, so that raising the iteration limit only continues the pixels that reached it.
+// status 0 once the pixel is done for good, 1 to carry on from here and 2 to start over
+struct PixelState {
+    dvec2 z;
+    dvec2 prevz;
+    dvec2 der;
+    dvec2 d; // the delta to the reference, its mantissa on the floatexp path
+    int i;
+    int m;
+    int e; // exponent of the floatexp delta
+    int status;
+};
+layout(std430, binding = 9) buffer pixel_states {
+    PixelState states[];
+};
+// pixels the compute kernel takes one by one, indices into the frame ordered by tile, and the next one to hand out
+layout(std430, binding = 10) buffer work_queue {
+    uint queue_head;
+    uint queue[];
+};
+uniform uint queue_end;
+layout(rgba32f, binding = 6) uniform writeonly image2D computeImage;
+
+uniform bool resume; // continue the pixels with status 1 instead of starting over
+uniform bool store_state;
+uniform int iter_limit; // where this pass stops, below max_iters while a large count is spread over several passes
 
 layout(binding = 0) uniform sampler2D computeTex;
 layout(binding = 1) uniform sampler2D postprocTex;
@@ -78,6 +151,11 @@ layout(binding = 2) uniform sampler2D juliaTex;
 
 layout(binding = 3) uniform sampler2D prevFrameTex;
 layout(r32ui, binding = 4) uniform uimage2D accIndex;
+layout(r32ui, binding = 5) uniform uimage2D glitchMask; // 1 where the perturbed orbit can't be trusted
+
+uniform bool rebasing;
+uniform bool glitch_detection;
+uniform bool glitch_pass; // only recompute pixels flagged in glitchMask
 
 uniform int op;
 
@@ -299,6 +377,199 @@ dvec2 csqrt(dvec2 z) {
     return sqrt(r) * (z + dvec2(0.f, r)) / length(z + dvec2(0.f, r));
 }
 
+// the same in single precision, for the equations of the shallow zoom path
+vec2 cexp(vec2 z) {
+    return exp(z.x) * vec2(cos(z.y), sin(z.y));
+}
+vec2 cconj(vec2 z) {
+    return vec2(z.x, -z.y);
+}
+float carg(vec2 z) {
+    return atan(z.y, z.x);
+}
+vec2 cmultiply(vec2 a, vec2 b) {
+    return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+vec2 cdivide(vec2 a, vec2 b) {
+    return vec2((a.x * b.x + a.y * b.y), (a.y * b.x - a.x * b.y)) / (b.x * b.x + b.y * b.y);
+}
+vec2 clog(vec2 z) {
+    return vec2(log(length(z)), carg(z));
+}
+vec2 cpow(vec2 z, float p) {
+    float xsq = z.x * z.x, ysq = z.y * z.y;
+    if (p == 0.f)
+        return vec2(1.f, 0.f);
+    if (p == 1.f)
+        return z;
+    if (p == 2.f)
+        return vec2(xsq - ysq, 2 * z.x * z.y);
+    if (p == 3.f)
+        return vec2(xsq * z.x - 3 * z.x * ysq, 3 * xsq * z.y - ysq * z.y);
+    if (p == 4.f)
+        return vec2(xsq * xsq + ysq * ysq - 6 * xsq * ysq, 4 * xsq * z.x * z.y - 4 * z.x * ysq * z.y);
+    if (p == 5.f)
+        return vec2(xsq * xsq * z.x + 5 * z.x * ysq * ysq - 10 * xsq * z.x * ysq,
+            5 * xsq * xsq * z.y + ysq * ysq * z.y - 10 * xsq * ysq * z.y);
+    float theta = atan(z.y, z.x);
+    return pow(length(z), p) * vec2(cos(p * theta), sin(p * theta));
+}
+vec2 cpow(vec2 a, vec2 b) {
+    float r = length(a);
+    if (r == 0.f) return vec2(0.f);
+    return cexp(cmultiply(b, vec2(log(r), carg(a))));
+}
+vec2 csin(vec2 z) {
+    return vec2(sin(z.x) * cosh(z.y), cos(z.x) * sinh(z.y));
+}
+vec2 ccos(vec2 z) {
+    return vec2(cos(z.x) * cosh(z.y), -sin(z.x) * sinh(z.y));
+}
+vec2 csqrt(vec2 z) {
+    float r = length(z);
+    return sqrt(r) * (z + vec2(0.f, r)) / length(z + vec2(0.f, r));
+}
+
+// float-float arithmetic for the emulated double loop. a real is a vec2 holding hi + lo with lo below half an
+// ulp of hi, about 48 bits of mantissa out of two floats, and a complex number a vec4 of two of them. precise
+// stops the compiler from reassociating the error terms away
+vec2 df_two_sum(float a, float b) {
+    precise float s = a + b;
+    precise float v = s - a;
+    precise float e = (a - (s - v)) + (b - v);
+    return vec2(s, e);
+}
+vec2 df_quick_two_sum(float a, float b) {
+    precise float s = a + b;
+    precise float e = b - (s - a);
+    return vec2(s, e);
+}
+// the error term of the product comes from a fused multiply-add, or from splitting the factors in halves when
+// it is 0, which is always the case where fma is a separate multiply and add like on llvmpipe. a product that
+// really is exact goes through the split as well and comes out the same
+vec2 df_two_prod(float a, float b) {
+    precise float p = a * b;
+    precise float e = fma(a, b, -p);
+    if (e == 0.f) {
+        precise float ca = 4097.f * a, cb = 4097.f * b;
+        precise float ah = ca - (ca - a), bh = cb - (cb - b);
+        precise float al = a - ah, bl = b - bh;
+        e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+    }
+    return vec2(p, e);
+}
+vec2 df_add(vec2 a, vec2 b) {
+    vec2 s = df_two_sum(a.x, b.x);
+    vec2 t = df_two_sum(a.y, b.y);
+    s = df_quick_two_sum(s.x, s.y + t.x);
+    return df_quick_two_sum(s.x, s.y + t.y);
+}
+vec2 df_sub(vec2 a, vec2 b) {
+    return df_add(a, -b);
+}
+vec2 df_mul(vec2 a, vec2 b) {
+    vec2 p = df_two_prod(a.x, b.x);
+    return df_quick_two_sum(p.x, p.y + (a.x * b.y + a.y * b.x));
+}
+vec2 df_div(vec2 a, vec2 b) {
+    float q = a.x / b.x;
+    vec2 r = df_sub(a, df_mul(b, vec2(q, 0.f)));
+    return df_quick_two_sum(q, r.x / b.x);
+}
+vec2 df_sqrt(vec2 a) {
+    if (a.x <= 0.f) return vec2(0.f);
+    float s = sqrt(a.x);
+    vec2 r = df_sub(a, df_two_prod(s, s));
+    return df_quick_two_sum(s, r.x / (2.f * s));
+}
+vec2 df_abs(vec2 a) {
+    return a.x < 0.f ? -a : a;
+}
+vec2 df_from(double a) {
+    float hi = float(a);
+    return vec2(hi, float(a - hi));
+}
+double df_to_double(vec2 a) {
+    return double(a.x) + double(a.y);
+}
+
+vec4 dfc_from(dvec2 z) {
+    return vec4(df_from(z.x), df_from(z.y));
+}
+dvec2 dfc_to_dvec2(vec4 z) {
+    return dvec2(df_to_double(z.xy), df_to_double(z.zw));
+}
+// componentwise, what + - * / do to a dvec2
+vec4 dfc_add(vec4 a, vec4 b) {
+    return vec4(df_add(a.xy, b.xy), df_add(a.zw, b.zw));
+}
+vec4 dfc_sub(vec4 a, vec4 b) {
+    return vec4(df_sub(a.xy, b.xy), df_sub(a.zw, b.zw));
+}
+vec4 dfc_scale(vec4 a, vec4 b) {
+    return vec4(df_mul(a.xy, b.xy), df_mul(a.zw, b.zw));
+}
+vec4 dfc_shrink(vec4 a, vec4 b) {
+    return vec4(df_div(a.xy, b.xy), df_div(a.zw, b.zw));
+}
+// and the complex functions. the transcendental ones only keep float accuracy, like cpow of doubles does for
+// non-integer powers
+vec4 dfc_cmultiply(vec4 a, vec4 b) {
+    return vec4(df_sub(df_mul(a.xy, b.xy), df_mul(a.zw, b.zw)), df_add(df_mul(a.xy, b.zw), df_mul(a.zw, b.xy)));
+}
+vec4 dfc_cdivide(vec4 a, vec4 b) {
+    vec2 d = df_add(df_mul(b.xy, b.xy), df_mul(b.zw, b.zw));
+    return vec4(df_div(df_add(df_mul(a.xy, b.xy), df_mul(a.zw, b.zw)), d),
+                df_div(df_sub(df_mul(a.zw, b.xy), df_mul(a.xy, b.zw)), d));
+}
+vec4 dfc_cconj(vec4 z) {
+    return vec4(z.xy, -z.zw);
+}
+vec2 dfc_length(vec4 z) {
+    return df_sqrt(df_add(df_mul(z.xy, z.xy), df_mul(z.zw, z.zw)));
+}
+vec2 dfc_carg(vec4 z) {
+    return vec2(atan(z.z, z.x), 0.f);
+}
+vec4 dfc_cpow(vec4 z, float p) {
+    if (p == 0.f)
+        return vec4(1.f, 0.f, 0.f, 0.f);
+    if (floor(p) == p && p > 0.f && p <= 8.f) {
+        vec4 r = z;
+        for (int k = 1; k < int(p); k++)
+            r = dfc_cmultiply(r, z);
+        return r;
+    }
+    vec2 w = vec2(cpow(vec2(z.x, z.z), p));
+    return vec4(w.x, 0.f, w.y, 0.f);
+}
+vec4 dfc_cpow(vec4 a, vec4 b) {
+    vec2 w = cpow(vec2(a.x, a.z), vec2(b.x, b.z));
+    return vec4(w.x, 0.f, w.y, 0.f);
+}
+vec4 dfc_cexp(vec4 z) {
+    vec2 w = cexp(vec2(z.x, z.z));
+    return vec4(w.x, 0.f, w.y, 0.f);
+}
+vec4 dfc_clog(vec4 z) {
+    vec2 w = clog(vec2(z.x, z.z));
+    return vec4(w.x, 0.f, w.y, 0.f);
+}
+vec4 dfc_csin(vec4 z) {
+    vec2 w = csin(vec2(z.x, z.z));
+    return vec4(w.x, 0.f, w.y, 0.f);
+}
+vec4 dfc_ccos(vec4 z) {
+    vec2 w = ccos(vec2(z.x, z.z));
+    return vec4(w.x, 0.f, w.y, 0.f);
+}
+vec4 dfc_csqrt(vec4 z) {
+    vec2 r = dfc_length(z);
+    vec4 w = dfc_add(z, vec4(0.f, 0.f, r));
+    vec2 s = df_div(df_sqrt(r), dfc_length(w));
+    return dfc_scale(w, vec4(s, s));
+}
+
 vec3 color(float i) {
     if (i < 0.f) return set_color;
     switch (transfer_function) {
@@ -329,6 +600,117 @@ vec3 color(float i) {
     return vec3(0.f);
 }
 
+// complex number with a shared extended exponent, m * 2^e
+struct floatexp {
+    dvec2 m;
+    int e;
+};
+
+floatexp fe_normalize(dvec2 m, int e) {
+    double a = max(abs(m.x), abs(m.y));
+    if (a == 0.0) return floatexp(dvec2(0.0), 0);
+    int ex;
+    frexp(a, ex);
+    return floatexp(ldexp(m, ivec2(-ex)), e + ex);
+}
+
+floatexp fe_add(floatexp a, floatexp b) {
+    if (a.m == dvec2(0.0)) return b;
+    if (b.m == dvec2(0.0)) return a;
+    if (a.e < b.e) {
+        floatexp t = a;
+        a = b;
+        b = t;
+    }
+    if (a.e - b.e > 60) return a;
+    return fe_normalize(a.m + ldexp(b.m, ivec2(b.e - a.e)), a.e);
+}
+
+floatexp fe_add(floatexp a, dvec2 b) {
+    return fe_add(a, fe_normalize(b, 0));
+}
+
+floatexp fe_mul(floatexp a, floatexp b) {
+    return fe_normalize(cmultiply(a.m, b.m), a.e + b.e);
+}
+
+floatexp fe_mul(dvec2 a, floatexp b) {
+    return fe_normalize(cmultiply(a, b.m), b.e);
+}
+
+dvec2 fe_to_dvec2(floatexp a) {
+    if (a.e < -1070) return dvec2(0.0);
+    return ldexp(a.m, ivec2(a.e));
+}
+
+// |a| < |b|
+bool fe_less(floatexp a, floatexp b) {
+    if (b.m == dvec2(0.0)) return false;
+    if (a.m == dvec2(0.0)) return true;
+    int diff = a.e - b.e;
+    if (diff > 1) return false;
+    if (diff < -1) return true;
+    return dot(a.m, a.m) * exp2(2.0 * diff) < dot(b.m, b.m);
+}
+
+// position of a pixel in a compressed reference orbit
+struct RefCursor {
+    int i;
+    dvec2 z;
+    int next; // next waypoint
+};
+
+void ref_step(inout RefCursor cur) {
+    // rounds exactly like OrbitReader::next_z() on the cpu
+    precise dvec2 z = dvec2(cur.z.x * cur.z.x - cur.z.y * cur.z.y, 2.0 * cur.z.x * cur.z.y) + ref_c;
+    cur.i++;
+    cur.z = z;
+    if (cur.next < num_waypoints && waypoints[cur.next].index == cur.i) {
+        cur.z = waypoints[cur.next].z;
+        cur.next++;
+    }
+}
+
+// reference[i] for either form of the orbit. pixels mostly move one iteration forward, anything
+// that goes back or past a waypoint starts over from the closest waypoint instead
+dvec2 ref_at(inout RefCursor cur, int i) {
+    if (!ref_compressed) return reference[i];
+    if (i < cur.i || (cur.next < num_waypoints && waypoints[cur.next].index <= i)) {
+        int lo = 0, hi = num_waypoints - 1;
+        while (lo < hi) {
+            int mid = (lo + hi + 1) / 2;
+            if (waypoints[mid].index <= i) lo = mid;
+            else hi = mid - 1;
+        }
+        cur = RefCursor(waypoints[lo].index, waypoints[lo].z, lo + 1);
+    }
+    while (cur.i < i) ref_step(cur);
+    return cur.z;
+}
+
+// mariani-silver subdivision. the first pass computes every 32nd row and column, each following one the lines
+// halfway between those of the last, down to single pixels. a pixel inside a block whose border is entirely
+// in the set is in the set as well, the set has no holes
+const int coarsest_subdivision = 32;
+
+int line_spacing(int x) {
+    return x == 0 ? coarsest_subdivision : min(coarsest_subdivision, x & -x);
+}
+
+// whether the border of the size pixels wide block at lo, computed by the earlier passes, is all in the set
+bool block_in_set(ivec2 lo, int size) {
+    ivec2 hi = lo + size;
+    if (hi.x >= frameSize.x || hi.y >= frameSize.y) return false;
+    for (int k = 0; k <= size; k++) {
+        ivec2 border[4] = ivec2[4](ivec2(lo.x + k, lo.y), ivec2(lo.x + k, hi.y), ivec2(lo.x, lo.y + k), ivec2(hi.x, lo.y + k));
+        for (int b = 0; b < 4; b++) {
+            // glitched pixels are stored as in the set too until they are fixed
+            if (texelFetch(computeTex, border[b], 0).y != -1.f || imageLoad(glitchMask, border[b]).x != 0u) return false;
+        }
+    }
+    return true;
+}
+
 float smooth_color(dvec2 z, dvec2 prevz, float power, int i, int max_iters) {
     float s;
     if (distance(z, prevz) > 1e-2) {
@@ -344,111 +726,505 @@ float smooth_color(dvec2 z, dvec2 prevz, float power, int i, int max_iters) {
     return s;
 }
 
+// finds the longest approximation that is valid for a pixel at reference iteration m, returns its index or -1
+int bla_lookup(int m, dvec2 d, int max_skip, out int skip) {
+    int j = m - 1;
+    if (j < 0) return -1;
+    // level 0 only replaces a single iteration, which the regular step does exactly
+    for (int l = bla_levels - 1; l >= 1; l--) {
+        skip = 1 << l;
+        if ((j & (skip - 1)) != 0 || skip > max_skip) continue;
+        int index = bla_offsets[l] + (j >> l);
+        if (index < bla_offsets[l + 1] && dot(d, d) < bla[index].r * bla[index].r) return index;
+    }
+    return -1;
+}
+
 dvec2 advance(dvec2 z, dvec2 c, dvec2 prevz, double xsq, double ysq, int i) {
     return %s;
 }
 
+bool bailout(dvec2 z, dvec2 c, dvec2 prevz, double xsq, double ysq, int i) {
+    return %s;
+}
+
+// the equation and the bailout with their doubles turned into floats
+vec2 advance_single(vec2 z, vec2 c, vec2 prevz, float xsq, float ysq, int i) {
+    return vec2(%s);
+}
+
+bool bailout_single(vec2 z, vec2 c, vec2 prevz, float xsq, float ysq, int i) {
+    return %s;
+}
+
+// and in float-float, with every operation on doubles turned into a df_ or dfc_ call
+vec4 advance_emulated(vec4 z, vec4 c, vec4 prevz, vec2 xsq, vec2 ysq, int i) {
+    return %s;
+}
+
+bool bailout_emulated(vec4 z, vec4 c, vec4 prevz, vec2 xsq, vec2 ysq, int i) {
+    return %s;
+}
+
+// (Z + d)^power - Z^power for integer powers, expanded so that nothing cancels
+dvec2 binomial(dvec2 Z, dvec2 d) {
+    int p = int(power);
+    dvec2 zk[8]; // Z^0 ... Z^(p - 1)
+    zk[0] = dvec2(1.0, 0.0);
+    for (int k = 1; k < p; k++) zk[k] = cmultiply(zk[k - 1], Z);
+    // horner in d over C(p, k) Z^(p - k) d^(k - 1), k from p down to 1
+    dvec2 s = dvec2(1.0, 0.0);
+    double binom = 1.0;
+    for (int k = p - 1; k >= 1; k--) {
+        binom = binom * (k + 1) / (p - k);
+        s = cmultiply(s, d) + binom * zk[p - k];
+    }
+    return cmultiply(s, d);
+}
+
+// |a + b| - |a| without the cancellation of computing it directly
+double diffabs(double a, double b) {
+    if (a >= 0.0) return a + b >= 0.0 ? b : -(2.0 * a + b);
+    return a + b > 0.0 ? 2.0 * a + b : -b;
+}
+
+// (|X + x| + i|Y + y|)^2 - (|X| + i|Y|)^2
+dvec2 ship_delta(dvec2 Z, dvec2 d) {
+    return dvec2((2.0 * Z.x + d.x) * d.x - (2.0 * Z.y + d.y) * d.y,
+                 2.0 * diffabs(Z.x * Z.y, Z.x * d.y + d.x * Z.y + d.x * d.y));
+}
+
+// next delta of a pixel from the reference Z, its delta d and its offset dc from the reference point
+dvec2 perturb(dvec2 Z, dvec2 d, dvec2 dc) {
+    return %s;
+}
+
 dvec2 differentiate(dvec2 z, dvec2 der) {
     der = cmultiply(cpow(z, power - 1.f), der) * power + 1.0;
     return der;
 }
 
-void main() {
+vec2 differentiate(vec2 z, vec2 der) {
+    return cmultiply(cpow(z, power - 1.f), der) * power + 1.f;
+}
+
+// the compute pass for one pixel, shared by the fragment pass and the compute kernel. leaves the result in
+// fragColor, or sets skipped for pixels this pass doesn't touch
+bool skipped = false;
+
+void compute_pixel(ivec2 pixel) {
     dvec2 nv = cexp(dvec2(0.f, angle * 2.f * M_PI / 360.f));
+    if (glitch_pass) {
+        if (imageLoad(glitchMask, pixel).x == 0u) { skipped = true; return; }
+        imageStore(glitchMask, pixel, uvec4(0u));
+    }
+    int state = pixel.y * frameSize.x + pixel.x;
+    if (subdivision > 0) {
+        int spacing = max(line_spacing(pixel.x), line_spacing(pixel.y));
+        if (spacing != subdivision) { skipped = true; return; }
+        if (spacing < coarsest_subdivision && block_in_set(pixel / (2 * spacing) * (2 * spacing), 2 * spacing)) {
+            // nothing to carry on from, raising the limit starts the pixel over
+            if (store_state) states[state].status = 2;
+            fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+            return;
+        }
+    }
+    bool resumed = false;
+    if (resume && !glitch_pass) {
+        // escaped pixels keep what the last pass left in computeTex
+        if (states[state].status == 0) { skipped = true; return; }
+        resumed = states[state].status == 1;
+    }
 
-    if (op == 3) {
-        dvec2 c = cmultiply((dvec2(gl_FragCoord.x / frameSize.x, gl_FragCoord.y / frameSize.y) - dvec2(0.5, 0.5)) * dvec2(julia_zoom, julia_zoom), dvec2(cos(theta), sin(theta))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
-        dvec2 z = c;
-        dvec2 prevz = z;
+    vec2 fragCoord = vec2(pixel) + 0.5f;
+    if (taa) fragCoord += (vec2(rand(vec2(time, fragCoord.x)), rand(vec2(time, fragCoord.y))) * 2.f - 1.f) / 2.f;
+    
+    dvec2 dz = cmultiply((fragCoord.xy / frameSize - dvec2(0.5, 0.5)) * dvec2(zoom, (frameSize.y * zoom) / frameSize.x), dvec2(cos(theta), sin(theta))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
+    dvec2 c = center + dz;
+    dvec2 dc = dz + ref_offset;
+    dvec2 d = dc;
+
+    floatexp fdc, fd;
+    if (perturbation && use_floatexp) {
+        // dz and ref_offset are both relative to 2^zoom_exponent here
+        dvec2 scaled = cmultiply((fragCoord.xy / frameSize - dvec2(0.5, 0.5)) * dvec2(zoom_mantissa, (frameSize.y * zoom_mantissa) / frameSize.x), dvec2(cos(theta), sin(theta))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
+        fdc = fe_normalize(scaled + ref_offset_scaled, zoom_exponent);
+        fd = fdc;
+    }
 
-        dvec2 der = dvec2(1.0, 0.0);
+    if (power == 2.f && cardioid_check) {
+        double q = (c.x - 0.25) * (c.x - 0.25) + c.y * c.y;
+        bool cardioid = q * (q + (c.x - 0.25)) <= 0.25 * c.y * c.y;
+        bool bulb = (c.x + 1.0) * (c.x + 1.0) + c.y * c.y <= 0.0625;
+        if (cardioid || bulb) {
+            if (store_state) states[state].status = 0;
+            fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+            return;
+        }
+    }
 
-        double xsq = z.x * z.x;
-        double ysq = z.y * z.y;
+    dvec2 z = %s;
+    dvec2 prevz = dvec2(0.0);
 
-        for (int i = 1; i < julia_maxiters; i++) {
-            if (%s) {
+    dvec2 der = dvec2(1.0, 0.0);
+
+    double xsq = z.x * z.x;
+    double ysq = z.y * z.y;
+
+    int m = ref_start; // index of the reference iteration the pixel follows
+    RefCursor cur = RefCursor(0, dvec2(0.0), 1);
+    int start = 0;
+
+    // brent's cycle detection: z is saved after 1, 2, 4, 8... steps and an orbit that comes back to it
+    // closer than a fraction of the pixel spacing repeats and never escapes. perturbed pixels compare their
+    // delta at the same reference iteration instead, z itself has long lost the digits that tell them apart
+    double tolerance = zoom / frameSize.x * 1e-3;
+    tolerance *= tolerance;
+    int window = 1, steps = 0;
+    bool delta_path; // this iteration went through the double perturbation path
+
+    if (single_precision && !perturbation) {
+        // the loop below in floats, which most gpus run many times faster than doubles
+        vec2 zs = vec2(z), cs = vec2(c), prevzs = vec2(0.f), ders = vec2(1.f, 0.f), saved_s = zs;
+        float xsqs = zs.x * zs.x, ysqs = zs.y * zs.y;
+        for (int i = 0; i < iter_limit; i++) {
+            if (i > 0 && bailout_single(zs, cs, prevzs, xsqs, ysqs, i)) {
                 float t = 0;
                 if (normal_map_effect) {
-                    dvec2 u = cdivide(z, der);
-                    u = u / length(u);
-                    t = float(u.x * nv.x + u.y * nv.y + height) / (1.f + height);
-                    if (t < 0) t = 0;
+                    vec2 u = normalize(cdivide(zs, ders));
+                    t = max((u.x * float(nv.x) + u.y * float(nv.y) + height) / (1.f + height), 0.f);
                 }
-                float s = smooth_color(z, prevz, power, i, max_iters);
-                float final = (continuous_coloring && s >= 1 && s < julia_maxiters) ? s : (i - 1);
-                fragColor = vec4(mix(vec3(0.f), vec3(color((continuous_coloring ? final : i))), normal_map_effect ? pow(t, 1.f / 1.8f) : 1.f), 1.f);
+                float s = smooth_color(dvec2(zs), dvec2(prevzs), power, i, max_iters);
+                fragColor = continuous_coloring ? vec4(s, i, t, 0.f) : vec4(i, i, t, 0.f);
                 return;
             }
             if (normal_map_effect)
-                der = differentiate(z, der);
-            prevz = z;
-            z = advance(z, mouseCoord, prevz, xsq, ysq, i);
-            xsq = z.x * z.x;
-            ysq = z.y * z.y;
+                ders = differentiate(zs, ders);
+            prevzs = zs;
+            zs = advance_single(zs, cs, prevzs, xsqs, ysqs, i);
+            xsqs = zs.x * zs.x;
+            ysqs = zs.y * zs.y;
+            if (periodicity) {
+                vec2 e = zs - saved_s;
+                if (dot(e, e) <= tolerance) {
+                    fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+                    return;
+                }
+                if (++steps == window) {
+                    saved_s = zs;
+                    steps = 0;
+                    window *= 2;
+                }
+            }
         }
-        fragColor = vec4(set_color, 1.0);
+        fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+        return;
     }
 
-    if (op == 2) {
-        vec2 fragCoord = gl_FragCoord.xy;
-        if (taa) fragCoord += (vec2(rand(vec2(time, gl_FragCoord.x)), rand(vec2(time, gl_FragCoord.y))) * 2.f - 1.f) / 2.f;
-        
-        dvec2 dz = cmultiply((fragCoord.xy / frameSize - dvec2(0.5, 0.5)) * dvec2(zoom, (frameSize.y * zoom) / frameSize.x), dvec2(cos(theta), sin(theta))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
-        dvec2 d = dz;
-        dvec2 c = center + dz;
-
-        if (power == 2.f && cardioid_check) {
-            double q = (c.x - 0.25) * (c.x - 0.25) + c.y * c.y;
-            bool cardioid = q * (q + (c.x - 0.25)) <= 0.25 * c.y * c.y;
-            bool bulb = (c.x + 1.0) * (c.x + 1.0) + c.y * c.y <= 0.0625;
-            if (cardioid || bulb) {
+    if (emulated_double && !perturbation) {
+        // the same in pairs of floats, a little less precise than doubles and faster wherever doubles are slow
+        vec4 ze = dfc_from(z), ce = dfc_from(c), prevze = vec4(0.f), saved_e = ze;
+        vec2 ders = vec2(1.f, 0.f);
+        vec2 xsqe = df_mul(ze.xy, ze.xy), ysqe = df_mul(ze.zw, ze.zw);
+        for (int i = 0; i < iter_limit; i++) {
+            if (i > 0 && bailout_emulated(ze, ce, prevze, xsqe, ysqe, i)) {
+                float t = 0;
+                if (normal_map_effect) {
+                    vec2 u = normalize(cdivide(vec2(ze.x, ze.z), ders));
+                    t = max((u.x * float(nv.x) + u.y * float(nv.y) + height) / (1.f + height), 0.f);
+                }
+                float s = smooth_color(dfc_to_dvec2(ze), dfc_to_dvec2(prevze), power, i, max_iters);
+                fragColor = continuous_coloring ? vec4(s, i, t, 0.f) : vec4(i, i, t, 0.f);
+                return;
+            }
+            if (normal_map_effect)
+                ders = differentiate(vec2(ze.x, ze.z), ders);
+            prevze = ze;
+            ze = advance_emulated(ze, ce, prevze, xsqe, ysqe, i);
+            xsqe = df_mul(ze.xy, ze.xy);
+            ysqe = df_mul(ze.zw, ze.zw);
+            if (periodicity) {
+                vec4 e = dfc_sub(ze, saved_e);
+                if (e.x * e.x + e.z * e.z <= float(tolerance)) {
+                    fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+                    return;
+                }
+                if (++steps == window) {
+                    saved_e = ze;
+                    steps = 0;
+                    window *= 2;
+                }
+            }
+        }
+        fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+        return;
+    }
+
+    if (perturbation && series_approx && !normal_map_effect && !use_floatexp && sa_skip > 1 && !resumed) {
+        // d = a_1 u + a_2 u^2 + ... with u = dc / r
+        dvec2 u = dc / sa_radius;
+        dvec2 s = dvec2(0.0);
+        for (int k = sa_terms - 1; k >= 0; k--)
+            s = cmultiply(s, u) + coeffs[k];
+        d = cmultiply(s, u);
+        m = sa_skip;
+        z = ref_at(cur, m) + d;
+        prevz = z;
+        xsq = z.x * z.x;
+        ysq = z.y * z.y;
+        start = sa_skip - 1;
+    }
+    if (resumed) {
+        PixelState s = states[state];
+        z = s.z;
+        prevz = s.prevz;
+        der = s.der;
+        d = s.d;
+        fd = floatexp(s.d, s.e);
+        m = s.m;
+        xsq = z.x * z.x;
+        ysq = z.y * z.y;
+        start = s.i;
+    }
+    dvec2 saved = perturbation ? d : z;
+    int saved_m = m;
+
+    if (batch_size > 0 && !perturbation) {
+        // run whole batches with the bailout folded into a flag instead of a branch per iteration. the batch
+        // that trips it is undone and stepped through one iteration at a time below, which repeats the exact
+        // same operations and leaves z, prevz and i as if it had never been batched
+        while (start + batch_size <= iter_limit) {
+            dvec2 batch_z = z, batch_prevz = prevz, batch_der = der;
+            bool escaped = false;
+            for (int b = 0; b < batch_size; b += 8) {
+                for (int k = 0; k < 8; k++) {
+                    int i = start + b + k;
+                    escaped = escaped || (i > 0 && bailout(z, c, prevz, xsq, ysq, i));
+                    if (normal_map_effect)
+                        der = differentiate(z, der);
+                    prevz = z;
+                    z = advance(z, c, prevz, xsq, ysq, i);
+                    xsq = z.x * z.x;
+                    ysq = z.y * z.y;
+                }
+            }
+            if (escaped) {
+                z = batch_z;
+                prevz = batch_prevz;
+                der = batch_der;
+                xsq = z.x * z.x;
+                ysq = z.y * z.y;
+                break;
+            }
+            start += batch_size;
+            // the same cycle detection as below with z sampled once per batch
+            if (periodicity) {
+                dvec2 e = z - saved;
+                if (dot(e, e) <= tolerance) {
+                    if (store_state) states[state].status = 0;
+                    fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+                    return;
+                }
+                steps += batch_size;
+                if (steps >= window) {
+                    saved = z;
+                    steps = 0;
+                    window *= 2;
+                }
+            }
+        }
+    }
+
+    for (int i = start; i < iter_limit; i++) {
+        if (i > 0 && bailout(z, c, prevz, xsq, ysq, i)) {
+            double t = 0;
+            if (normal_map_effect) {
+                dvec2 u = cdivide(z, der);
+                u = u / length(u);
+                t = (u.x * nv.x + u.y * nv.y + height) / (1.f + height);
+                if (t < 0) t = 0;
+            }
+
+            float s = smooth_color(z, prevz, power, i, max_iters);
+            if (continuous_coloring && i > 0) {
+                fragColor = vec4(s, i, t, 0.f);
+            }
+            else {
+                fragColor = vec4(i, i, t, 0.f);
+            }
+            if (store_state) states[state].status = 0;
+            return;
+        }
+        if (normal_map_effect)
+            der = differentiate(z, der);
+        prevz = z;
+        delta_path = false;
+        if (perturbation && use_floatexp && m + 1 < reforbit_size) {
+            // same as below without the approximations, which only exist for doubles
+            fd = fe_add(fe_add(fe_mul(2.0 * ref_at(cur, m), fd), fe_mul(fd, fd)), fdc);
+            m++;
+            dvec2 Z = ref_at(cur, m);
+            floatexp fz = fe_add(fd, Z);
+            z = fe_to_dvec2(fz);
+            if (rebasing && (fe_less(fz, fd) || m + 1 == reforbit_size)) {
+                fd = fz;
+                m = 0;
+            }
+            else if (glitch_detection && fe_less(fz, fe_normalize(Z * 1e-3, 0))) {
+                imageStore(glitchMask, pixel, uvec4(1u));
+                if (store_state) states[state].status = 2;
                 fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
                 return;
             }
         }
+        else if (perturbation && m + 1 < reforbit_size) {
+            delta_path = true;
+            int skip;
+            int index = (bla_levels > 0 && !normal_map_effect) ? bla_lookup(m, d, iter_limit - i - 1, skip) : -1;
+            if (index >= 0) {
+                d = cmultiply(bla[index].A, d) + cmultiply(bla[index].B, dc);
+                m += skip;
+                i += skip - 1;
+            }
+            else {
+                d = perturb(ref_at(cur, m), d, dc);
+                m++;
+            }
+            dvec2 Z = ref_at(cur, m);
+            z = Z + d;
+            // zhuoran's rebasing: once z gets closer to 0 than to the reference, follow the orbit
+            // from its start again. the same happens when the end of the orbit is reached
+            if (rebasing && ref_start == 1 && (dot(z, z) < dot(d, d) || m + 1 == reforbit_size)) {
+                d = z;
+                m = 0;
+            }
+            // pauldelbrot's criterion: |z| much smaller than |Z| means the delta lost all its precision
+            else if (glitch_detection && dot(z, z) < 1e-6 * dot(Z, Z)) {
+                imageStore(glitchMask, pixel, uvec4(1u));
+                if (store_state) states[state].status = 2;
+                fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+                return;
+            }
+        }
+        else if (perturbation && glitch_detection && reforbit_size > 0 && reforbit_size <= max_iters) {
+            // the reference escaped before this pixel did
+            imageStore(glitchMask, pixel, uvec4(1u));
+            if (store_state) states[state].status = 2;
+            fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+            return;
+        }
+        else {
+            z = advance(z, c, prevz, xsq, ysq, i);
+        }
+        xsq = z.x * z.x;
+        ysq = z.y * z.y;
+        // the floatexp path and pixels that ran past the reference have no delta to compare
+        if (periodicity && (!perturbation || delta_path)) {
+            dvec2 w = perturbation ? d : z;
+            dvec2 e = w - saved;
+            if (m == saved_m && dot(e, e) <= tolerance) {
+                if (store_state) states[state].status = 0;
+                fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+                return;
+            }
+            if (++steps == window) {
+                saved = w;
+                saved_m = m;
+                steps = 0;
+                window *= 2;
+            }
+        }
+    }
+    if (store_state) {
+        // the deltas of a glitch pass belong to a secondary reference that is gone by the next pass
+        states[state] = PixelState(z, prevz, der, use_floatexp ? fd.m : d, iter_limit, m, use_floatexp ? fd.e : 0, glitch_pass ? 2 : 1);
+    }
+    fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+}
 
-        dvec2 z = %s;
-        dvec2 prevz = dvec2(0.0);
+#ifdef COMPUTE_KERNEL
+// persistent threads: a fixed number of workgroups keep taking the next pixel off the queue until it runs dry, so an
+// invocation whose pixel escaped early moves on to another one instead of waiting for the slowest pixel of its draw
+void main() {
+    while (true) {
+        uint item = atomicAdd(queue_head, 1u);
+        if (item >= queue_end) return;
+        int index = int(queue[item]);
+        ivec2 pixel = ivec2(index % frameSize.x, index / frameSize.x);
+        skipped = false;
+        compute_pixel(pixel);
+        if (!skipped) imageStore(computeImage, pixel, fragColor);
+    }
+}
+#else
+void main() {
+    dvec2 nv = cexp(dvec2(0.f, angle * 2.f * M_PI / 360.f));
+
+    if (op == 3) {
+        dvec2 c = cmultiply((dvec2(gl_FragCoord.x / frameSize.x, gl_FragCoord.y / frameSize.y) - dvec2(0.5, 0.5)) * dvec2(julia_zoom, julia_zoom), dvec2(cos(theta), sin(theta))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
+        dvec2 z = c;
+        dvec2 prevz = z;
 
         dvec2 der = dvec2(1.0, 0.0);
 
         double xsq = z.x * z.x;
         double ysq = z.y * z.y;
 
-        for (int i = 0; i < max_iters; i++) {
-            if (i > 0 && %s) {
-                double t = 0;
+        // the orbit of the main reference starts at 0 and follows Z^2 + C, so it is also the orbit of the middle of
+        // the julia set of C. pixels perturb it in z, and by julia_dc in the constant
+        bool perturbed = perturbation && reforbit_size > 0 && ref_start == 1;
+        dvec2 d = z;
+        int m = 0;
+        RefCursor cur = RefCursor(0, dvec2(0.0), 1);
+
+        for (int i = 1; i < julia_maxiters; i++) {
+            if (%s) {
+                float t = 0;
                 if (normal_map_effect) {
                     dvec2 u = cdivide(z, der);
                     u = u / length(u);
-                    t = (u.x * nv.x + u.y * nv.y + height) / (1.f + height);
+                    t = float(u.x * nv.x + u.y * nv.y + height) / (1.f + height);
                     if (t < 0) t = 0;
                 }
-
                 float s = smooth_color(z, prevz, power, i, max_iters);
-                if (continuous_coloring && i > 0) {
-                    fragColor = vec4(s, i, t, 0.f);
-                }
-                else {
-                    fragColor = vec4(i, i, t, 0.f);
-                }
+                float final = (continuous_coloring && s >= 1 && s < julia_maxiters) ? s : (i - 1);
+                fragColor = vec4(mix(vec3(0.f), vec3(color((continuous_coloring ? final : i))), normal_map_effect ? pow(t, 1.f / 1.8f) : 1.f), 1.f);
                 return;
             }
             if (normal_map_effect)
                 der = differentiate(z, der);
             prevz = z;
-            if (perturbation) {
-                d = 2.0 * cmultiply(reference[i], d) + cpow(d, 2) + dz;
-                z = reference[i+1] + d;
+            if (perturbed) {
+                int skip;
+                int index = (bla_levels > 0 && !normal_map_effect) ? bla_lookup(m, d, julia_maxiters - i - 1, skip) : -1;
+                if (index >= 0) {
+                    d = cmultiply(bla[index].A, d) + cmultiply(bla[index].B, julia_dc);
+                    m += skip;
+                    i += skip - 1;
+                }
+                else {
+                    d = perturb(ref_at(cur, m), d, julia_dc);
+                    m++;
+                }
+                z = ref_at(cur, m) + d;
+                // always rebasing, the preview has no glitch correction and the orbit may end before the pixel
+                if (dot(z, z) < dot(d, d) || m + 1 >= reforbit_size) {
+                    d = z;
+                    m = 0;
+                }
             }
             else {
-                z = advance(z, c, prevz, xsq, ysq, i);
+                z = advance(z, mouseCoord, prevz, xsq, ysq, i);
             }
             xsq = z.x * z.x;
             ysq = z.y * z.y;
         }
-        fragColor = vec4(-1.f, -1.f, 0.f, 0.f);
+        fragColor = vec4(set_color, 1.0);
+    }
+
+    if (op == 2) {
+        compute_pixel(ivec2(gl_FragCoord.xy));
+        if (skipped) discard;
     }
     if (op == 1) {
         if (ssaa_factor == 1) {
@@ -512,4 +1288,5 @@ void main() {
         vec4 texel = texture(postprocTex, gl_FragCoord.xy / frameSize);
         fragColor = texel;
     }
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
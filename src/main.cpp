@@ -57,6 +57,27 @@
 #include <cmath>
 #include <complex>
 #include <regex>
+#include <thread>
+#include <random>
+#include <mutex>
+#include <condition_variable>
+#include <array>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstring>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#endif
+#ifndef PLATFORM_WINDOWS
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 using namespace glm;
 
@@ -314,6 +335,27 @@ void main() {
 
 )";
 
+// gmp, mpfr and mpc allocate through these once they are installed at startup, so the
+// count covers limb buffers as well as the temporaries the libraries make internally
+struct MPAllocations {
+    static inline std::atomic<uint64_t> count = 0;
+
+    static void* allocate(size_t size) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size);
+    }
+    static void* reallocate(void* ptr, size_t, size_t size) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        return std::realloc(ptr, size);
+    }
+    static void release(void* ptr, size_t) {
+        std::free(ptr);
+    }
+    static void install() {
+        mp_set_memory_functions(allocate, reallocate, release);
+    }
+};
+
 class MPC {
     mpfr_prec_t prec;
     mpc_rnd_t mode = MPC_RNDZZ;
@@ -334,9 +376,9 @@ public:
         mpc_init2(value, prec);
         mpc_set_d_d(value, (double)v.x, (double)v.y, mode);
     }
-    MPC(const char* str, mpfr_prec_t p) : prec(p) {
+    MPC(const char* str, mpfr_prec_t p, int base = 10) : prec(p) {
         mpc_init2(value, p);
-        if (mpc_strtoc(value, str, nullptr, 10, mode) == -1) {
+        if (mpc_strtoc(value, str, nullptr, base, mode) == -1) {
             throw std::runtime_error("Invalid number string");
         }
     }
@@ -345,6 +387,7 @@ public:
     }
 
     void change_prec(mpfr_prec_t p) {
+        if (p == prec) return;
         prec = p;
         mpc_t tmp;
         mpc_init2(tmp, prec);
@@ -353,6 +396,22 @@ public:
         mpc_clear(tmp);
     }
 
+    // like change_prec but drops the value, growing the limbs only if they are too small
+    void set_prec(mpfr_prec_t p) {
+        if (p == prec) return;
+        prec = p;
+        mpc_set_prec(value, prec);
+    }
+    mpfr_prec_t get_prec() const {
+        return prec;
+    }
+
+    // in-place operations for the hot paths, they work in this value's limbs and take
+    // their temporaries from the scratch pool, so they don't allocate once it is warm
+    MPC& sqr_add(const MPC& c);
+    MPC& mul_add(const MPC& a, const MPC& b);
+    MPC& add_scaled(const glm::dvec2& v, long exponent);
+
     double real() const {
         return mpfr_get_d(mpc_realref(value), MPFR_RNDN);
     }
@@ -373,16 +432,24 @@ public:
         return glm::dvec2(real(), imag());
     }
 
+    bool operator==(const MPC& z) const {
+        return mpc_cmp(value, z.value) == 0;
+    }
+    bool operator!=(const MPC& z) const {
+        return !(*this == z);
+    }
+
     MPC& operator=(const MPC& z) {
         if (this != &z) {
-            mpc_set_prec(value, mpc_get_prec(z.value));
+            set_prec(z.prec);
             mpc_set(value, z.value, mode);
         }
         return *this;
     }
     template <typename T, glm::qualifier Q>
     MPC& operator=(const glm::vec<2, T, Q>& v) {
-        return *this = MPC(v, prec);
+        mpc_set_d_d(value, (double)v.x, (double)v.y, mode);
+        return *this;
     }
 
     MPC& operator+=(const MPC& z) {
@@ -391,7 +458,9 @@ public:
     }
     template <typename T, glm::qualifier Q>
     MPC& operator+=(const glm::vec<2, T, Q>& v) {
-        return *this += MPC(v, prec);
+        mpfr_add_d(mpc_realref(value), mpc_realref(value), (double)v.x, MPC_RND_RE(mode));
+        mpfr_add_d(mpc_imagref(value), mpc_imagref(value), (double)v.y, MPC_RND_IM(mode));
+        return *this;
     }
     MPC& operator+=(const double& val) {
         return *this += dvec2(val, 0.0);
@@ -403,7 +472,9 @@ public:
     }
     template <typename T, glm::qualifier Q>
     MPC& operator-=(const glm::vec<2, T, Q>& v) {
-        return *this -= MPC(v, prec);
+        mpfr_sub_d(mpc_realref(value), mpc_realref(value), (double)v.x, MPC_RND_RE(mode));
+        mpfr_sub_d(mpc_imagref(value), mpc_imagref(value), (double)v.y, MPC_RND_IM(mode));
+        return *this;
     }
     MPC& operator-=(const double& val) {
         return *this -= dvec2(val, 0.0);
@@ -444,7 +515,8 @@ public:
     }
     template <typename T, glm::qualifier Q>
     MPC operator+(const glm::vec<2, T, Q>& v) const {
-        return *this + MPC(v, prec);
+        MPC result(*this);
+        return result += v;
     }
     MPC operator+(const double& val) const {
         return *this + dvec2(val, 0.0);
@@ -457,7 +529,8 @@ public:
     }
     template <typename T, glm::qualifier Q>
     MPC operator-(const glm::vec<2, T, Q>& v) const {
-        return *this - MPC(v, prec);
+        MPC result(*this);
+        return result -= v;
     }
     MPC operator-(const double& val) const {
         return *this - dvec2(val, 0.0);
@@ -473,7 +546,7 @@ public:
         MPC result(*this);
         mpfr_mul_d(mpc_realref(result.value), mpc_realref(value), (double)v.x, MPFR_RNDN);
         mpfr_mul_d(mpc_imagref(result.value), mpc_imagref(value), (double)v.y, MPFR_RNDN);
-        return *this;
+        return result;
     }
     MPC operator*(const double& val) const {
         return *this * dvec2(val);
@@ -489,7 +562,7 @@ public:
         MPC result(*this);
         mpfr_div_d(mpc_realref(result.value), mpc_realref(value), (double)v.x, MPFR_RNDN);
         mpfr_div_d(mpc_imagref(result.value), mpc_imagref(value), (double)v.y, MPFR_RNDN);
-        return *this;
+        return result;
     }
     MPC operator/(const double& val) const {
         return *this / dvec2(val);
@@ -501,6 +574,13 @@ public:
         mpc_free_str(s);
         return out;
     }
+    // every bit of the value, in base 16 so that reading it back is exact whatever the rounding
+    std::string hex() const {
+        char* s = mpc_get_str(16, 0, value, mode);
+        std::string out(s);
+        mpc_free_str(s);
+        return out;
+    }
     std::string str_re() const {
         char* s;
         mpfr_asprintf(&s, std::format("%.{}Rg", static_cast<int>(prec * log10(2.0))).c_str(), mpc_realref(value));
@@ -517,10 +597,1767 @@ public:
     }
 };
 
+// borrows a temporary from a per-thread free list, so each thread only allocates the
+// first time it needs one (or a larger precision than it has seen so far)
+class ScratchMPC {
+    static inline thread_local std::vector<std::unique_ptr<MPC>> pool;
+    std::unique_ptr<MPC> z;
+public:
+    ScratchMPC(mpfr_prec_t p) {
+        if (pool.empty()) {
+            z = std::make_unique<MPC>(p);
+        }
+        else {
+            z = std::move(pool.back());
+            pool.pop_back();
+            z->set_prec(p);
+        }
+    }
+    ~ScratchMPC() {
+        pool.push_back(std::move(z));
+    }
+    ScratchMPC(const ScratchMPC&) = delete;
+    ScratchMPC& operator=(const ScratchMPC&) = delete;
+
+    MPC& operator*() { return *z; }
+    MPC* operator->() { return z.get(); }
+};
+
+// z = z^2 + c, the real part as (x + y)(x - y) so it takes two multiplications like the imaginary one
+inline MPC& MPC::sqr_add(const MPC& c) {
+    ScratchMPC t(prec);
+    mpfr_ptr x = mpc_realref(value);
+    mpfr_ptr y = mpc_imagref(value);
+    mpfr_ptr sum = mpc_realref(t->value);
+    mpfr_ptr diff = mpc_imagref(t->value);
+    mpfr_add(sum, x, y, MPC_RND_RE(mode));
+    mpfr_sub(diff, x, y, MPC_RND_RE(mode));
+    mpfr_mul(y, x, y, MPC_RND_IM(mode));
+    mpfr_mul_2ui(y, y, 1, MPC_RND_IM(mode));
+    mpfr_add(y, y, mpc_imagref(c.value), MPC_RND_IM(mode));
+    mpfr_mul(x, sum, diff, MPC_RND_RE(mode));
+    mpfr_add(x, x, mpc_realref(c.value), MPC_RND_RE(mode));
+    return *this;
+}
+
+// z = z * a + b
+inline MPC& MPC::mul_add(const MPC& a, const MPC& b) {
+    ScratchMPC t(prec);
+    mpfr_srcptr x = mpc_realref(value);
+    mpfr_srcptr y = mpc_imagref(value);
+    mpfr_fmms(mpc_realref(t->value), x, mpc_realref(a.value), y, mpc_imagref(a.value), MPC_RND_RE(mode));
+    mpfr_fmma(mpc_imagref(t->value), x, mpc_imagref(a.value), y, mpc_realref(a.value), MPC_RND_IM(mode));
+    mpc_add(value, t->value, b.value, mode);
+    return *this;
+}
+
+// z = z + v * 2^exponent, for offsets that are too small for a double on their own
+inline MPC& MPC::add_scaled(const glm::dvec2& v, long exponent) {
+    ScratchMPC t(53);
+    mpc_set_d_d(t->value, v.x, v.y, mode);
+    mpc_mul_2si(t->value, t->value, exponent, mode);
+    mpc_add(value, value, t->value, mode);
+    return *this;
+}
+
+// a double mantissa with a separate exponent, for scales past the ~1e-308 limit of doubles
+struct floatexp {
+    double m = 0.0; // 0.5 <= |m| < 1, or 0
+    int64_t e = 0;
+
+    floatexp() = default;
+    floatexp(double x) : floatexp(x, 0) {}
+    floatexp(double mantissa, int64_t exponent) {
+        int ex;
+        m = std::frexp(mantissa, &ex);
+        e = (m == 0.0 ? 0 : exponent + ex);
+    }
+
+    // 2^x
+    static floatexp exp2(double x) {
+        double whole = std::floor(x);
+        return floatexp(std::exp2(x - whole), static_cast<int64_t>(whole));
+    }
+
+    // accepts the same formats as strtod, but with an exponent of any size
+    static floatexp parse(const std::string& str) {
+        size_t pos = str.find_first_of("eE");
+        floatexp result(std::stod(str.substr(0, pos)));
+        if (pos != std::string::npos)
+            result *= exp2(std::stoll(str.substr(pos + 1)) * std::log2(10.0));
+        return result;
+    }
+
+    double to_double() const {
+        return std::ldexp(m, static_cast<int>(std::clamp<int64_t>(e, -2000, 2000)));
+    }
+    explicit operator double() const {
+        return to_double();
+    }
+
+    double log2() const {
+        return std::log2(std::abs(m)) + e;
+    }
+
+    std::string str(int digits = 2) const {
+        if (m == 0.0) return std::format("{:.{}e}", 0.0, digits);
+        double l = log2() * std::log10(2.0);
+        double e10 = std::floor(l);
+        double mantissa = std::pow(10.0, l - e10);
+        if (std::round(mantissa * std::pow(10.0, digits)) >= 10.0 * std::pow(10.0, digits)) {
+            mantissa /= 10.0;
+            e10 += 1.0;
+        }
+        return std::format("{}{:.{}f}e{}{:02}", m < 0 ? "-" : "", mantissa, digits, e10 < 0 ? "-" : "+", static_cast<int64_t>(std::abs(e10)));
+    }
+
+    floatexp operator*(const floatexp& x) const {
+        return floatexp(m * x.m, e + x.e);
+    }
+    floatexp operator/(const floatexp& x) const {
+        return floatexp(m / x.m, e - x.e);
+    }
+    floatexp& operator*=(const floatexp& x) {
+        return *this = *this * x;
+    }
+    floatexp& operator/=(const floatexp& x) {
+        return *this = *this / x;
+    }
+    floatexp operator+(const floatexp& x) const {
+        if (m == 0.0) return x;
+        if (x.m == 0.0) return *this;
+        if (e < x.e) return x + *this;
+        return floatexp(m + std::ldexp(x.m, static_cast<int>(std::max<int64_t>(x.e - e, -1100))), e);
+    }
+    floatexp operator-() const {
+        floatexp result = *this;
+        result.m = -m;
+        return result;
+    }
+    floatexp operator-(const floatexp& x) const {
+        return *this + -x;
+    }
+
+    bool operator<(const floatexp& x) const {
+        return (*this - x).m < 0.0;
+    }
+    bool operator>(const floatexp& x) const {
+        return x < *this;
+    }
+    bool operator<=(const floatexp& x) const {
+        return !(x < *this);
+    }
+    bool operator>=(const floatexp& x) const {
+        return !(*this < x);
+    }
+    bool operator==(const floatexp& x) const {
+        return m == x.m && e == x.e;
+    }
+};
+
+static floatexp pow(const floatexp& x, double p) {
+    return floatexp::exp2(x.log2() * p);
+}
+
+// lets a long computation notice that its result is no longer wanted
+struct CancelToken {
+    const std::atomic<uint64_t>* generation = nullptr;
+    uint64_t id = 0;
+
+    bool cancelled() const {
+        return generation && generation->load(std::memory_order_relaxed) != id;
+    }
+};
+
+// a point of a compressed orbit. in between, the orbit is recomputed as Z^2 + C in double, exactly like
+// ref_step() in render.glsl, and a waypoint is only stored where that drifts too far from the real orbit
+struct Waypoint {
+    dvec2 z;
+    int index;
+    int pad[3]; // std430 rounds the struct up to 32 bytes
+};
+
+constexpr double compression_tolerance = 0x1p-40; // relative error allowed before the next waypoint
+
+// the recurrence the reference orbit follows, it has to agree with the perturbation formula of the fractal
+enum class ReferenceFormula { None, Mandelbrot, Tricorn, BurningShip, Julia };
+
+struct OrbitFormula {
+    ReferenceFormula kind = ReferenceFormula::Mandelbrot;
+    int power = 2;
+    dvec2 julia = dvec2(0.0); // the constant added by julia sets, as the shader sees it
+
+    bool operator==(const OrbitFormula&) const = default;
+
+    // Z^2 + C, the only formula the approximations, the compression and the fast paths for the reference are written for
+    bool quadratic() const {
+        return kind == ReferenceFormula::Mandelbrot && power == 2;
+    }
+    // julia orbits start at the reference point, the others at the critical point 0 which pixels can rebase to
+    int start() const {
+        return kind == ReferenceFormula::Julia ? 0 : 1;
+    }
+};
+
+struct OrbitData {
+    OrbitFormula formula;
+    bool compressed = false;
+    int length = 0; // number of iterations, in either form
+    int period = 0; // if the reference is a nucleus, the orbit repeats after this many iterations
+    dvec2 c = dvec2(0.0); // the reference point as a double, used to recompute compressed orbits
+    std::vector<dvec2> orbit; // every iteration, empty if compressed
+    std::vector<Waypoint> waypoints;
+
+    size_t bytes() const {
+        return compressed ? waypoints.size() * sizeof(Waypoint) : orbit.size() * sizeof(dvec2);
+    }
+    double compression_ratio() const {
+        return bytes() ? static_cast<double>(length * sizeof(dvec2)) / bytes() : 1.0;
+    }
+
+    void clear() {
+        length = 0;
+        orbit.clear();
+        waypoints.clear();
+    }
+};
+
+// walks an orbit from its start in either form
+class OrbitReader {
+    const OrbitData& data;
+    int i = 0;
+    size_t next = 0; // next waypoint
+    dvec2 z = dvec2(0.0);
+public:
+    OrbitReader(const OrbitData& data) : data(data) {}
+
+    // Z_i, then moves on to i + 1
+    dvec2 next_z() {
+        if (!data.compressed) return data.orbit[i++];
+        if (next < data.waypoints.size() && data.waypoints[next].index == i)
+            z = data.waypoints[next++].z;
+        dvec2 current = z;
+        z = dvec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + data.c;
+        i++;
+        return current;
+    }
+};
+
+// a * b + c + carry, returns the low half and leaves the high half in carry. it can't overflow
+static inline uint64_t mul_add_limb(uint64_t a, uint64_t b, uint64_t c, uint64_t& carry) {
+#ifdef _MSC_VER
+    uint64_t hi;
+    uint64_t lo = _umul128(a, b, &hi);
+    lo += c;
+    hi += lo < c;
+    lo += carry;
+    hi += lo < carry;
+    carry = hi;
+    return lo;
+#else
+    unsigned __int128 t = static_cast<unsigned __int128>(a) * b + c + carry;
+    carry = static_cast<uint64_t>(t >> 64);
+    return static_cast<uint64_t>(t);
+#endif
+}
+
+// two's complement fixed point with N 64 bit limbs, least significant first. the top 8 bits hold the
+// sign and the integer part, which is enough for every value the reference takes before it escapes
+template <int N>
+struct FixedPoint {
+    static constexpr int frac_bits = 64 * N - 8;
+    std::array<uint64_t, N> limbs{};
+
+    FixedPoint() = default;
+    explicit FixedPoint(mpfr_srcptr v) {
+        mpz_t m;
+        mpz_init(m);
+        mpfr_exp_t e = mpfr_get_z_2exp(m, v) + frac_bits;
+        if (e >= 0) mpz_mul_2exp(m, m, e);
+        else mpz_tdiv_q_2exp(m, m, -e);
+        mpz_export(limbs.data(), nullptr, -1, sizeof(uint64_t), 0, 0, m);
+        if (mpz_sgn(m) < 0) *this = -*this;
+        mpz_clear(m);
+    }
+
+    void store(mpfr_ptr v) const {
+        FixedPoint magnitude = abs();
+        mpz_t m;
+        mpz_init(m);
+        mpz_import(m, N, -1, sizeof(uint64_t), 0, 0, magnitude.limbs.data());
+        if (negative()) mpz_neg(m, m);
+        mpfr_set_z_2exp(v, m, -frac_bits, MPFR_RNDN);
+        mpz_clear(m);
+    }
+
+    double to_double() const {
+        FixedPoint magnitude = abs();
+        int top = N - 1;
+        while (top > 0 && magnitude.limbs[top] == 0) top--;
+        double out = std::ldexp(static_cast<double>(magnitude.limbs[top]), 64 * top - frac_bits);
+        if (top > 0) out += std::ldexp(static_cast<double>(magnitude.limbs[top - 1]), 64 * (top - 1) - frac_bits);
+        return negative() ? -out : out;
+    }
+
+    bool negative() const {
+        return limbs[N - 1] >> 63;
+    }
+    FixedPoint abs() const {
+        return negative() ? -*this : *this;
+    }
+
+    FixedPoint operator-() const {
+        FixedPoint r;
+        uint64_t carry = 1;
+        for (int i = 0; i < N; i++) {
+            r.limbs[i] = ~limbs[i] + carry;
+            carry = r.limbs[i] < carry;
+        }
+        return r;
+    }
+    FixedPoint operator+(const FixedPoint& b) const {
+        FixedPoint r;
+        uint64_t carry = 0;
+        for (int i = 0; i < N; i++) {
+            uint64_t sum = limbs[i] + b.limbs[i];
+            uint64_t out = sum + carry;
+            carry = (sum < limbs[i]) | (out < sum);
+            r.limbs[i] = out;
+        }
+        return r;
+    }
+    FixedPoint operator-(const FixedPoint& b) const {
+        FixedPoint r;
+        uint64_t borrow = 0;
+        for (int i = 0; i < N; i++) {
+            uint64_t d = limbs[i] - b.limbs[i];
+            uint64_t out = d - borrow;
+            borrow = (limbs[i] < b.limbs[i]) | (d < borrow);
+            r.limbs[i] = out;
+        }
+        return r;
+    }
+    // products are truncated, signs are handled on the magnitudes
+    FixedPoint operator*(const FixedPoint& b) const {
+        FixedPoint r = shift_product(multiply(abs().limbs, b.abs().limbs));
+        return negative() != b.negative() ? -r : r;
+    }
+    FixedPoint sqr() const {
+        return shift_product(square(abs().limbs));
+    }
+
+private:
+    using Product = std::array<uint64_t, 2 * N>;
+
+    static Product multiply(const std::array<uint64_t, N>& a, const std::array<uint64_t, N>& b) {
+        Product p{};
+        for (int i = 0; i < N; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; j < N; j++) {
+                p[i + j] = mul_add_limb(a[i], b[j], p[i + j], carry);
+            }
+            p[i + N] = carry;
+        }
+        return p;
+    }
+    // the products off the diagonal appear twice, so they are computed once and doubled
+    static Product square(const std::array<uint64_t, N>& a) {
+        Product p{};
+        for (int i = 0; i < N; i++) {
+            uint64_t carry = 0;
+            for (int j = i + 1; j < N; j++) {
+                p[i + j] = mul_add_limb(a[i], a[j], p[i + j], carry);
+            }
+            p[i + N] = carry;
+        }
+        uint64_t top = 0;
+        for (int k = 0; k < 2 * N; k++) {
+            uint64_t v = p[k];
+            p[k] = (v << 1) | top;
+            top = v >> 63;
+        }
+        uint64_t carry = 0;
+        for (int i = 0; i < N; i++) {
+            uint64_t hi = carry;
+            p[2 * i] = mul_add_limb(a[i], a[i], p[2 * i], hi);
+            p[2 * i + 1] += hi;
+            carry = p[2 * i + 1] < hi;
+        }
+        return p;
+    }
+    // drops the extra fraction bits of a product, frac_bits = 64 (N - 1) + 56
+    static FixedPoint shift_product(const Product& p) {
+        FixedPoint r;
+        for (int i = 0; i < N; i++) {
+            r.limbs[i] = (p[N - 1 + i] >> 56) | (p[N + i] << 8);
+        }
+        return r;
+    }
+};
+
+template <int N>
+struct FixedComplex {
+    FixedPoint<N> x, y;
+
+    explicit FixedComplex(const MPC& z) : x(mpc_realref(z.value)), y(mpc_imagref(z.value)) {}
+
+    void store(MPC& z) const {
+        x.store(mpc_realref(z.value));
+        y.store(mpc_imagref(z.value));
+    }
+    dvec2 to_dvec2() const {
+        return dvec2(x.to_double(), y.to_double());
+    }
+    void sqr_add(const FixedComplex& c) {
+        FixedPoint<N> xy = x * y;
+        x = x.sqr() - y.sqr() + c.x;
+        y = xy + xy + c.y;
+    }
+
+    // |z| has to stay below 10 until the escape check and |c| below 4, so that |z^2 + c| < 128.
+    // the precision also needs a few bits to spare, truncation loses about one per iteration
+    static bool fits(const MPC& c, mpfr_prec_t prec) {
+        return prec + 8 <= FixedPoint<N>::frac_bits && length(dvec2(c)) < 4.0;
+    }
+};
+
+// above this many bits a reference iteration is dominated by its three multiplications, x^2, y^2 and xy,
+// which are independent and worth running on separate cores
+constexpr mpfr_prec_t parallel_precision = 10000;
+
+// two threads that compute x^2 and y^2 while the caller computes xy. between iterations they spin instead of
+// sleeping, a condition variable would cost more than a product at these sizes, but yield to the scheduler if
+// the wait drags on because the cores are taken. the team only lives for one ReferenceOrbit::update so nothing
+// spins while the orbit is idle, and only one exists at a time so that teams don't spin against each other
+class ProductTeam {
+    static constexpr int helpers = 2;
+    static constexpr int spins_before_yield = 4096;
+    static inline std::atomic<bool> alive = false;
+    std::array<std::thread, helpers> threads;
+    std::atomic<uint64_t> phase = 0;
+    std::atomic<int> done = 0;
+    std::atomic<bool> stopping = false;
+    mpfr_srcptr operands[helpers];
+    mpfr_t products[helpers];
+    mpfr_t xy;
+
+    static void relax(int& spins) {
+        if (++spins >= spins_before_yield) {
+            spins = 0;
+            std::this_thread::yield();
+            return;
+        }
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    void run(int k) {
+        uint64_t seen = 0;
+        while (true) {
+            uint64_t current;
+            int spins = 0;
+            while ((current = phase.load(std::memory_order_acquire)) == seen) relax(spins);
+            seen = current;
+            if (stopping.load(std::memory_order_relaxed)) return;
+            mpfr_sqr(products[k], operands[k], MPFR_RNDN);
+            done.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+public:
+    // whether the caller may build a team, which it then holds until the team is destroyed. false while
+    // another one is alive
+    static bool claim() {
+        bool expected = false;
+        return std::thread::hardware_concurrency() > helpers && alive.compare_exchange_strong(expected, true);
+    }
+
+    ProductTeam(mpfr_prec_t prec) {
+        for (int k = 0; k < helpers; k++) {
+            mpfr_init2(products[k], prec * 2);
+        }
+        mpfr_init2(xy, prec * 2);
+        for (int k = 0; k < helpers; k++) {
+            threads[k] = std::thread(&ProductTeam::run, this, k);
+        }
+    }
+    ~ProductTeam() {
+        stopping.store(true, std::memory_order_relaxed);
+        phase.fetch_add(1, std::memory_order_release);
+        for (auto& t : threads) t.join();
+        for (int k = 0; k < helpers; k++) {
+            mpfr_clear(products[k]);
+        }
+        mpfr_clear(xy);
+        alive.store(false);
+    }
+
+    // z = z^2 + c. the products are kept exact at twice the precision so only the final sums round
+    void sqr_add(MPC& z, const MPC& c) {
+        mpfr_ptr x = mpc_realref(z.value);
+        mpfr_ptr y = mpc_imagref(z.value);
+        operands[0] = x;
+        operands[1] = y;
+        done.store(0, std::memory_order_relaxed);
+        phase.fetch_add(1, std::memory_order_release);
+        mpfr_mul(xy, x, y, MPFR_RNDN);
+        int spins = 0;
+        while (done.load(std::memory_order_acquire) < helpers) relax(spins);
+        mpfr_sub(x, products[0], products[1], MPFR_RNDN);
+        mpfr_add(x, x, mpc_realref(c.value), MPFR_RNDN);
+        mpfr_mul_2ui(y, xy, 1, MPFR_RNDN);
+        mpfr_add(y, y, mpc_imagref(c.value), MPFR_RNDN);
+    }
+};
+
+// reference orbit for perturbation, kept across frames and only recomputed when
+// the center or the precision changes. raising max_iters continues from the last z
+struct ReferenceOrbit {
+    MPC center{256};
+    MPC z{256};
+    MPC addend{256}; // center, or the constant of a julia set
+    mpfr_prec_t prec = 0;
+    int max_iters = 0;
+    bool escaped = false;
+    double seconds = 0.0; // spent iterating since the last reset, across cancellations
+    OrbitData data;
+    dvec2 shadow; // where the double recurrence lands for the next iteration when compressing
+
+    // returns true if the orbit has changed and needs to be uploaded again. a cancelled
+    // update returns false but keeps the iterations done so far, they are still valid
+    // constant is the julia constant at full precision, formula.julia is used without it
+    bool update(const MPC& c, mpfr_prec_t p, int iters, const OrbitFormula& formula = {}, bool compress = false, CancelToken token = {}, const MPC* constant = nullptr) {
+        compress = compress && formula.quadratic();
+        if (p != prec || c != center || formula != data.formula || compress != data.compressed || !same_constant(formula, constant))
+            reset(c, p, formula, compress, constant);
+        if (escaped || iters <= max_iters) return false;
+
+        if (!compress) data.orbit.reserve(iters + 1);
+        auto start = std::chrono::steady_clock::now();
+        bool finished;
+        // the common precisions run on fixed size limbs, mpfr is only needed above 496 bits
+        if (!data.formula.quadratic()) finished = iterate(iters, token, [&] { return step(); });
+        else if (FixedComplex<2>::fits(center, prec)) finished = iterate_fixed<2>(iters, token);
+        else if (FixedComplex<4>::fits(center, prec)) finished = iterate_fixed<4>(iters, token);
+        else if (FixedComplex<8>::fits(center, prec)) finished = iterate_fixed<8>(iters, token);
+        else if (prec >= parallel_precision && ProductTeam::claim()) {
+            ProductTeam team(prec);
+            finished = iterate(iters, token, [&] {
+                team.sqr_add(z, center);
+                return dvec2(z);
+            });
+        }
+        else finished = iterate(iters, token, [&] { return dvec2(z.sqr_add(center)); });
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!finished) return false;
+        max_iters = iters;
+        return true;
+    }
+
+    // true if update() with these arguments has nothing left to do
+    bool current(const MPC& c, mpfr_prec_t p, int iters, const OrbitFormula& formula, bool compress, const MPC* constant = nullptr) const {
+        compress = compress && formula.quadratic();
+        return p == prec && c == center && formula == data.formula && compress == data.compressed && same_constant(formula, constant) && (escaped || iters <= max_iters);
+    }
+
+    bool same_constant(const OrbitFormula& formula, const MPC* constant) const {
+        return formula.kind != ReferenceFormula::Julia || !constant || *constant == addend;
+    }
+
+    // back to iteration 0 for a new reference
+    void reset(const MPC& c, mpfr_prec_t p, const OrbitFormula& formula, bool compress, const MPC* constant = nullptr) {
+        prec = p;
+        center = c;
+        z.set_prec(p);
+        if (formula.kind == ReferenceFormula::Julia) {
+            z = center;
+            if (constant) {
+                addend = *constant;
+            }
+            else {
+                addend.set_prec(p);
+                addend = formula.julia;
+            }
+        }
+        else {
+            z = dvec2(0.0); // the orbit starts at Z_0 = 0 so that pixels can rebase to its start
+            addend = center;
+        }
+        max_iters = 0;
+        escaped = false;
+        seconds = 0.0;
+        data.clear();
+        data.formula = formula;
+        data.compressed = compress;
+        data.c = center;
+    }
+
+private:
+    // one iteration of any formula, the binomial powers go through mpc
+    dvec2 step() {
+        if (data.formula.kind == ReferenceFormula::Tricorn) {
+            mpc_conj(z.value, z.value, MPC_RNDNN);
+        }
+        else if (data.formula.kind == ReferenceFormula::BurningShip) {
+            mpfr_abs(mpc_realref(z.value), mpc_realref(z.value), MPFR_RNDN);
+            mpfr_abs(mpc_imagref(z.value), mpc_imagref(z.value), MPFR_RNDN);
+        }
+        if (data.formula.power == 2) {
+            z.sqr_add(addend);
+        }
+        else {
+            mpc_pow_ui(z.value, z.value, data.formula.power, MPC_RNDNN);
+            z += addend;
+        }
+        return z;
+    }
+
+    template <int N>
+    bool iterate_fixed(int iters, const CancelToken& token) {
+        FixedComplex<N> fz(z);
+        FixedComplex<N> fc(center);
+        bool finished = iterate(iters, token, [&] {
+            fz.sqr_add(fc);
+            return fz.to_dvec2();
+        });
+        fz.store(z); // so that raising max_iters can continue at any precision
+        return finished;
+    }
+
+    // step() advances z by one iteration and returns it as doubles
+    template <typename Step>
+    bool iterate(int iters, const CancelToken& token, Step step) {
+        dvec2 zd = z;
+        while (data.length <= iters) {
+            if (token.cancelled()) return false;
+            if (!data.compressed) {
+                data.orbit.push_back(zd);
+            }
+            else {
+                if (data.length < 2 || length(shadow - zd) > compression_tolerance * length(zd)) {
+                    data.waypoints.push_back({ zd, data.length });
+                    shadow = zd;
+                }
+                shadow = dvec2(shadow.x * shadow.x - shadow.y * shadow.y, 2.0 * shadow.x * shadow.y) + data.c;
+            }
+            data.length++;
+            zd = step();
+            if (zd.x * zd.x + zd.y * zd.y > 100.0) {
+                // julia pixels can't rebase, the ones escaping together with the reference need its last value
+                if (data.formula.start() == 0 && !data.compressed) {
+                    data.orbit.push_back(zd);
+                    data.length++;
+                }
+                escaped = true;
+                break;
+            }
+        }
+        return true;
+    }
+};
+
+// the first iterations of every pixel are approximated by a polynomial in dc, d_n = A_1 dc + A_2 dc^2 + ...
+// the coefficients are stored scaled by the radius of the view (a_k = A_k r^k) to keep them inside the double range
+struct SeriesApproximation {
+    int skip = 0; // number of iterations the polynomial replaces
+    double radius = 0.0;
+    std::vector<dvec2> coefficients; // a_1 ... a_k at iteration skip
+};
+
+static SeriesApproximation compute_series(const OrbitData& orbit, int terms, double radius) {
+    auto cmul = [](dvec2 a, dvec2 b) { return dvec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x); };
+    SeriesApproximation sa;
+    sa.radius = radius;
+    sa.coefficients.assign(terms, dvec2(0.0));
+    std::vector<dvec2> next(terms);
+    OrbitReader reader(orbit);
+    // the last two entries are kept so that the pixel still has an orbit to follow after the skip
+    for (int n = 0; n + 2 < orbit.length; n++) {
+        dvec2 Z = reader.next_z();
+        const std::vector<dvec2>& a = sa.coefficients;
+        // A_1' = 2 Z A_1 + 1, A_k' = 2 Z A_k + sum of A_j A_(k-j)
+        for (int k = 0; k < terms; k++) {
+            dvec2 sum = (k == 0 ? dvec2(radius, 0.0) : dvec2(0.0));
+            for (int j = 0; j < k; j++)
+                sum += cmul(a[j], a[k - 1 - j]);
+            next[k] = 2.0 * cmul(Z, a[k]) + sum;
+        }
+        // stop as soon as the last term is no longer negligible compared to the one before it
+        bool valid = std::isfinite(next[0].x) && std::isfinite(next[0].y);
+        if (terms > 1)
+            valid = valid && length(next[terms - 1]) * 1e3 <= length(next[terms - 2]);
+        if (!valid) break;
+        std::swap(sa.coefficients, next);
+        sa.skip = n + 1;
+    }
+    return sa;
+}
+
+// bivariate linear approximation: 2^l iterations starting at reference iteration m are replaced with
+// d' = A d + B dc as long as |d| < r. level l entry j starts at m = 1 + j * 2^l (pixels never start at 0)
+struct BLA {
+    dvec2 A;
+    dvec2 B;
+    double r;
+    double pad; // std430 rounds the struct up to 48 bytes
+};
+
+struct BLATable {
+    double radius = 0.0; // largest |dc| the table is valid for
+    std::vector<BLA> entries;
+    std::vector<int> offsets; // start of each level in entries, followed by the total size
+};
+
+constexpr int bla_max_levels = 31;
+
+static BLATable compute_bla(const OrbitData& orbit, double radius) {
+    auto cmul = [](dvec2 a, dvec2 b) { return dvec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x); };
+    const double epsilon = 0x1p-53; // keep the dropped d^2 term below double rounding error
+    BLATable table;
+    table.radius = radius;
+    int count = orbit.length - 2;
+    if (count < 1) return table;
+
+    OrbitReader reader(orbit);
+    reader.next_z();
+    table.entries.reserve(2 * count);
+    table.offsets.push_back(0);
+    for (int m = 1; m <= count; m++) {
+        // d' = 2 Z d + d^2 + dc, linear while d^2 is negligible next to 2 Z d
+        dvec2 Z = reader.next_z();
+        table.entries.push_back({ 2.0 * Z, dvec2(1.0, 0.0), epsilon * 2.0 * length(Z), 0.0 });
+    }
+    // merge neighbouring pairs, x followed by y: A = Ay Ax, B = Ay Bx + By, r = min(rx, (ry - |Bx| |dc|) / |Ax|)
+    while (count > 1 && table.offsets.size() < bla_max_levels) {
+        int prev = table.offsets.back();
+        table.offsets.push_back(table.entries.size());
+        count /= 2;
+        for (int j = 0; j < count; j++) {
+            BLA x = table.entries[prev + 2 * j];
+            BLA y = table.entries[prev + 2 * j + 1];
+            double r = std::max(0.0, (y.r - length(x.B) * radius) / length(x.A));
+            table.entries.push_back({ cmul(y.A, x.A), cmul(y.A, x.B) + y.B, std::min(x.r, r), 0.0 });
+        }
+    }
+    table.offsets.push_back(table.entries.size());
+    return table;
+}
+
+// |z| as a floatexp, near a deep nucleus both the distances and the newton steps are far below 1e-308
+static floatexp magnitude(const MPC& z) {
+    auto part = [](mpfr_srcptr x) {
+        if (mpfr_zero_p(x)) return floatexp();
+        long e;
+        double m = mpfr_get_d_2exp(&e, x, MPFR_RNDN);
+        return floatexp(m, e);
+    };
+    floatexp x = part(mpc_realref(z.value));
+    floatexp y = part(mpc_imagref(z.value));
+    floatexp sq = x * x + y * y;
+    return sq.m == 0.0 ? sq : pow(sq, 0.5);
+}
+
+// lowest period of a nucleus that can lie within radius of c. the disk is followed as a ball around the orbit
+// of c, |(z + e)^2 + c + dc - (z^2 + c)| <= 2|z||e| + |e|^2 + |dc|, and the first ball to cover 0 gives the period.
+// 0 if the ball escapes or max_iters is reached first
+static int find_period(const MPC& c, floatexp radius, int max_iters, const CancelToken& token) {
+    ScratchMPC z(c.get_prec());
+    *z = dvec2(0.0);
+    floatexp r = 0.0;
+    for (int n = 1; n <= max_iters; n++) {
+        if ((n & 1023) == 0 && token.cancelled()) return 0;
+        r = r * (magnitude(*z) * 2.0 + r) + radius;
+        z->sqr_add(c);
+        floatexp az = magnitude(*z);
+        if (az < r) return n;
+        if (az > r + 2.0) return 0;
+    }
+    return 0;
+}
+
+// newton's method for Z_period(c) = 0 starting from c, in place. false if it doesn't settle within the precision of c
+static bool find_nucleus(MPC& c, int period, const CancelToken& token) {
+    const int max_steps = 64;
+    mpfr_prec_t p = c.get_prec();
+    ScratchMPC z(p), dz(p), twice_z(p), one(p);
+    *one = dvec2(1.0, 0.0);
+    floatexp tolerance = floatexp::exp2(16.0 - static_cast<double>(p));
+    for (int step = 0; step < max_steps; step++) {
+        *z = dvec2(0.0);
+        *dz = dvec2(0.0);
+        for (int n = 0; n < period; n++) {
+            if ((n & 1023) == 1023 && token.cancelled()) return false;
+            // dZ/dc' = 2 Z dZ/dc + 1
+            mpc_mul_2ui(twice_z->value, z->value, 1, MPC_RNDNN);
+            dz->mul_add(*twice_z, *one);
+            z->sqr_add(c);
+        }
+        *z /= *dz;
+        if (!mpfr_number_p(mpc_realref(z->value)) || !mpfr_number_p(mpc_imagref(z->value))) return false;
+        c -= *z;
+        if (magnitude(*z) <= tolerance * (magnitude(c) + 1.0)) return true;
+    }
+    return false;
+}
+
+// how large the minibrot of a nucleus is compared to the whole set, 1 / |b L^2| with L = dZ/dZ_1 over the period
+// and b the sum of 1 / dZ_n/dZ_1. only Z needs the full precision, the derivatives are kept in 64 bits
+static floatexp minibrot_size(const MPC& nucleus, int period, const CancelToken& token) {
+    ScratchMPC z(nucleus.get_prec()), l(64), b(64), t(64);
+    *z = nucleus;
+    *l = dvec2(1.0, 0.0);
+    *b = dvec2(1.0, 0.0);
+    for (int n = 1; n < period; n++) {
+        if ((n & 1023) == 0 && token.cancelled()) return 0.0;
+        mpc_set(t->value, z->value, MPC_RNDNN);
+        mpc_mul(l->value, l->value, t->value, MPC_RNDNN);
+        mpc_mul_2ui(l->value, l->value, 1, MPC_RNDNN);
+        mpc_ui_div(t->value, 1, l->value, MPC_RNDNN);
+        mpc_add(b->value, b->value, t->value, MPC_RNDNN);
+        z->sqr_add(nucleus);
+    }
+    mpc_sqr(t->value, l->value, MPC_RNDNN);
+    mpc_mul(t->value, t->value, b->value, MPC_RNDNN);
+    floatexp denominator = magnitude(*t);
+    return denominator.m == 0.0 ? floatexp(0.0) : floatexp(1.0) / denominator;
+}
+
+// read-only view of a whole file, empty if it can't be opened
+class MappedFile {
+    const char* view = nullptr;
+    size_t length = 0;
+#ifdef PLATFORM_WINDOWS
+    HANDLE mapping = nullptr;
+#endif
+public:
+    MappedFile(const std::filesystem::path& path) {
+#ifdef PLATFORM_WINDOWS
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                length = view ? static_cast<size_t>(size.QuadPart) : 0;
+            }
+        }
+        CloseHandle(file); // the mapping keeps the file open
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                view = static_cast<const char*>(p);
+                length = st.st_size;
+            }
+        }
+        close(fd);
+#endif
+    }
+    ~MappedFile() {
+#ifdef PLATFORM_WINDOWS
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+#else
+        if (view) munmap(const_cast<char*>(view), length);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return view; }
+    size_t size() const { return length; }
+};
+
+// slow reference orbits are kept on disk so that coming back to a location doesn't recompute them. an entry
+// is a header followed by the key, the last iterate as text and the raw arrays, each starting on a 16 byte
+// boundary so that they can be used straight out of the mapping. entries are named after a hash of their key
+// and replaced as a whole, the key inside tells hash collisions apart
+struct OrbitCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key_size;
+    uint64_t z_size;
+    uint64_t orbit_size;
+    uint64_t waypoint_size;
+    uint64_t coefficient_size;
+    uint64_t bla_size;
+    uint64_t offset_size;
+    int32_t length;
+    int32_t max_iters;
+    int32_t escaped;
+    int32_t sa_skip;
+    dvec2 c;
+    dvec2 shadow;
+    double sa_radius;
+    double bla_radius;
+};
+
+constexpr char orbit_cache_magic[4] = { 'M', 'V', 'R', 'O' };
+constexpr uint32_t orbit_cache_version = 1;
+constexpr double orbit_cache_min_seconds = 0.5; // faster orbits aren't worth the disk space
+constexpr uintmax_t orbit_cache_max_bytes = uintmax_t(4) << 30; // least recently used entries go first
+
+static std::filesystem::path orbit_cache_directory() {
+#ifdef PLATFORM_WINDOWS
+    const char* base = std::getenv("LOCALAPPDATA");
+    std::filesystem::path dir = base ? std::filesystem::path(base) / "MV2" : std::filesystem::temp_directory_path() / "MV2";
+#else
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    std::filesystem::path dir = xdg ? std::filesystem::path(xdg) : home ? std::filesystem::path(home) / ".cache" : std::filesystem::temp_directory_path();
+    dir /= "mv2";
+#endif
+    return dir / "orbits";
+}
+
+static std::filesystem::path orbit_cache_path(const std::string& key, const char* extension) {
+    uint64_t hash = 14695981039346656037ull; // fnv-1a
+    for (unsigned char ch : key) {
+        hash ^= ch;
+        hash *= 1099511628211ull;
+    }
+    return orbit_cache_directory() / std::format("{:016x}.{}", hash, extension);
+}
+
+static std::string orbit_cache_key(const MPC& c, mpfr_prec_t p, const OrbitFormula& formula, bool compress, const MPC* constant) {
+    std::string julia = formula.kind != ReferenceFormula::Julia ? "" : constant ? constant->hex() : std::format("{} {}", formula.julia.x, formula.julia.y);
+    return std::format("{} {} {} {} {} {}", c.hex(), p, static_cast<int>(formula.kind), formula.power, julia, compress);
+}
+
+// drops the least recently used entries until the directory fits again, returns the bytes left. loading an
+// entry sets its write time, so the oldest one is also the one used longest ago
+static uintmax_t trim_orbit_cache() {
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+    uintmax_t total = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(orbit_cache_directory(), ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        total += entry.file_size(ec);
+        entries.push_back({ entry.last_write_time(ec), entry.path() });
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const auto& [time, path] : entries) {
+        if (total <= orbit_cache_max_bytes) break;
+        total -= std::filesystem::file_size(path, ec);
+        std::filesystem::remove(path, ec);
+    }
+    return total;
+}
+
+// keeps a running total of the cache size after a write changed it by change bytes. the directory is only walked
+// by the first write of the session and whenever the total goes over the limit
+static void account_orbit_cache(intmax_t change) {
+    static std::mutex mutex;
+    static uintmax_t total = 0;
+    static bool counted = false;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (counted) {
+        total = static_cast<uintmax_t>(std::max<intmax_t>(0, static_cast<intmax_t>(total) + change));
+        if (total <= orbit_cache_max_bytes) return;
+    }
+    total = trim_orbit_cache();
+    counted = true;
+}
+
+// marks an entry as recently used
+static void touch_orbit_cache(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+}
+
+// writes to a temporary file first so that an entry is never seen half written
+static void write_orbit_cache(const std::filesystem::path& path, const std::function<void(std::ofstream&)>& write) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream fout(tmp, std::ios::binary | std::ios::out | std::ofstream::trunc);
+        if (!fout) return;
+        write(fout);
+        if (!fout) {
+            fout.close();
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+    // the entry may replace an older one of the same key
+    uintmax_t old_size = std::filesystem::file_size(path, ec);
+    if (ec) old_size = 0;
+    uintmax_t new_size = std::filesystem::file_size(tmp, ec);
+    if (ec) new_size = 0;
+    std::filesystem::rename(tmp, path, ec);
+    if (!ec) account_orbit_cache(static_cast<intmax_t>(new_size) - static_cast<intmax_t>(old_size));
+}
+
+// reads the entry at path into the arguments, the approximations only if the entry has them
+static bool read_orbit_cache(const std::filesystem::path& path, const std::string& key, const MPC& c, mpfr_prec_t p, const OrbitFormula& formula, bool compress, const MPC* constant, ReferenceOrbit& reference, SeriesApproximation& series, BLATable& bla) {
+    MappedFile file(path);
+    if (file.size() < sizeof(OrbitCacheHeader)) return false;
+    OrbitCacheHeader h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, orbit_cache_magic, 4) != 0 || h.version != orbit_cache_version) return false;
+
+    size_t pos = sizeof(h);
+    auto section = [&](uint64_t count, size_t item) -> const char* {
+        pos = (pos + 15) & ~size_t(15);
+        if (count > (file.size() - std::min(pos, file.size())) / item) return nullptr;
+        const char* start = file.data() + pos;
+        pos += count * item;
+        return start;
+    };
+    const char* k = section(h.key_size, 1);
+    const char* z = section(h.z_size, 1);
+    const char* orbit = section(h.orbit_size, sizeof(dvec2));
+    const char* waypoints = section(h.waypoint_size, sizeof(Waypoint));
+    const char* coefficients = section(h.coefficient_size, sizeof(dvec2));
+    const char* entries = section(h.bla_size, sizeof(BLA));
+    const char* offsets = section(h.offset_size, sizeof(int));
+    if (!k || !z || !orbit || !waypoints || !coefficients || !entries || !offsets) return false;
+    if (std::string_view(k, h.key_size) != key) return false;
+
+    reference.reset(c, p, formula, compress, constant);
+    if (mpc_strtoc(reference.z.value, std::string(z, h.z_size).c_str(), nullptr, 16, MPC_RNDNN) == -1) {
+        reference.reset(c, p, formula, compress, constant);
+        return false;
+    }
+    reference.max_iters = h.max_iters;
+    reference.escaped = h.escaped;
+    reference.shadow = h.shadow;
+    reference.data.length = h.length;
+    reference.data.orbit.assign(reinterpret_cast<const dvec2*>(orbit), reinterpret_cast<const dvec2*>(orbit) + h.orbit_size);
+    reference.data.waypoints.assign(reinterpret_cast<const Waypoint*>(waypoints), reinterpret_cast<const Waypoint*>(waypoints) + h.waypoint_size);
+    // whatever the worker had before belongs to another orbit
+    series = SeriesApproximation();
+    bla = BLATable();
+    if (h.coefficient_size > 0) {
+        series.skip = h.sa_skip;
+        series.radius = h.sa_radius;
+        series.coefficients.assign(reinterpret_cast<const dvec2*>(coefficients), reinterpret_cast<const dvec2*>(coefficients) + h.coefficient_size);
+    }
+    if (h.bla_size > 0) {
+        bla.radius = h.bla_radius;
+        bla.entries.assign(reinterpret_cast<const BLA*>(entries), reinterpret_cast<const BLA*>(entries) + h.bla_size);
+        bla.offsets.assign(reinterpret_cast<const int*>(offsets), reinterpret_cast<const int*>(offsets) + h.offset_size);
+    }
+    return true;
+}
+
+// loads the entry for this reference into the arguments. the write time is set once the file is no longer mapped,
+// windows doesn't allow it before
+static bool load_orbit_cache(const MPC& c, mpfr_prec_t p, const OrbitFormula& formula, bool compress, const MPC* constant, ReferenceOrbit& reference, SeriesApproximation& series, BLATable& bla) {
+    compress = compress && formula.quadratic();
+    std::string key = orbit_cache_key(c, p, formula, compress, constant);
+    std::filesystem::path path = orbit_cache_path(key, "orbit");
+    if (!read_orbit_cache(path, key, c, p, formula, compress, constant, reference, series, bla)) return false;
+    touch_orbit_cache(path);
+    return true;
+}
+
+static void store_orbit_cache(const ReferenceOrbit& reference, const SeriesApproximation* series, const BLATable* bla) {
+    std::string key = orbit_cache_key(reference.center, reference.prec, reference.data.formula, reference.data.compressed, &reference.addend);
+    std::string z = reference.z.hex();
+    const OrbitData& data = reference.data;
+    OrbitCacheHeader h = {};
+    std::memcpy(h.magic, orbit_cache_magic, 4);
+    h.version = orbit_cache_version;
+    h.key_size = key.size();
+    h.z_size = z.size();
+    h.orbit_size = data.orbit.size();
+    h.waypoint_size = data.waypoints.size();
+    h.coefficient_size = series ? series->coefficients.size() : 0;
+    h.bla_size = bla ? bla->entries.size() : 0;
+    h.offset_size = bla ? bla->offsets.size() : 0;
+    h.length = data.length;
+    h.max_iters = reference.max_iters;
+    h.escaped = reference.escaped;
+    h.sa_skip = series ? series->skip : 0;
+    h.c = data.c;
+    h.shadow = reference.shadow;
+    h.sa_radius = series ? series->radius : 0.0;
+    h.bla_radius = bla ? bla->radius : 0.0;
+
+    write_orbit_cache(orbit_cache_path(key, "orbit"), [&](std::ofstream& fout) {
+        size_t pos = 0;
+        auto put = [&](const void* p, size_t bytes) {
+            static const char zeros[16] = {};
+            size_t pad = ((pos + 15) & ~size_t(15)) - pos;
+            fout.write(zeros, pad);
+            if (bytes) fout.write(static_cast<const char*>(p), bytes);
+            pos += pad + bytes;
+        };
+        put(&h, sizeof(h));
+        put(key.data(), key.size());
+        put(z.data(), z.size());
+        put(data.orbit.data(), data.orbit.size() * sizeof(dvec2));
+        put(data.waypoints.data(), data.waypoints.size() * sizeof(Waypoint));
+        put(series ? series->coefficients.data() : nullptr, h.coefficient_size * sizeof(dvec2));
+        put(bla ? bla->entries.data() : nullptr, h.bla_size * sizeof(BLA));
+        put(bla ? bla->offsets.data() : nullptr, h.offset_size * sizeof(int));
+    });
+}
+
+// nucleus searches are cached as text: the key, the period and the nucleus
+static std::string nucleus_cache_key(const MPC& c, mpfr_prec_t p, const floatexp& radius, int max_iters) {
+    return std::format("nucleus {} {} {} {} {}", c.hex(), p, radius.m, radius.e, max_iters);
+}
+
+static bool load_nucleus_cache(const std::string& key, mpfr_prec_t p, MPC& nucleus, int& period) {
+    std::filesystem::path path = orbit_cache_path(key, "nucleus");
+    std::ifstream fin(path);
+    std::string stored, value;
+    int n = 0;
+    if (!std::getline(fin, stored) || stored != key || !(fin >> n) || !std::getline(fin >> std::ws, value)) return false;
+    nucleus.set_prec(p);
+    if (mpc_strtoc(nucleus.value, value.c_str(), nullptr, 16, MPC_RNDNN) == -1) return false;
+    period = n;
+    fin.close();
+    touch_orbit_cache(path);
+    return true;
+}
+
+static void store_nucleus_cache(const std::string& key, const MPC& nucleus, int period) {
+    write_orbit_cache(orbit_cache_path(key, "nucleus"), [&](std::ofstream& fout) {
+        fout << key << '\n' << period << '\n' << nucleus.hex() << '\n';
+    });
+}
+
+// computes reference orbits on a background thread so that the UI doesn't freeze at high
+// precisions. finished orbits are published to a staging buffer which the GL thread swaps in
+class ReferenceWorker {
+    struct Job {
+        MPC center{256};
+        mpfr_prec_t prec = 0;
+        int max_iters = 0;
+        OrbitFormula formula;
+        MPC julia{64}; // the constant of julia formulas at full precision
+        int terms = 0; // series approximation terms, 0 if it isn't used
+        double radius = 0.0;
+        bool bla = false;
+        bool compress = false;
+        floatexp nucleus_radius = 0.0; // look for a nucleus this close to the center, 0 to use the center itself
+        bool cache = false; // look for slow orbits on disk first and keep new ones there
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<uint64_t> generation = 0;
+    std::atomic<bool> busy = false;
+    bool pending = false;
+    bool stop = false;
+    Job job;
+
+    Job requested; // last request, only touched by the GL thread
+    ReferenceOrbit reference; // only touched by the worker thread
+
+    bool ready = false;
+    OrbitData staging;
+    MPC staging_center{256};
+    bool staging_extends = false; // the staged orbit only continues the one the GL thread has, pixels stopped against it stay valid
+    // the orbit that was staged last, only touched by the worker thread. a job cancelled between finishing the orbit
+    // and staging it leaves one the GL thread never got, which the next job has to publish even if it computes nothing
+    MPC staged_center{256};
+    MPC staged_addend{256};
+    mpfr_prec_t staged_prec = 0;
+    int staged_length = -1;
+    OrbitFormula staged_formula;
+    bool staged_compressed = false;
+    bool series_ready = false;
+    SeriesApproximation series; // only touched by the worker thread
+    SeriesApproximation staging_series;
+    bool bla_ready = false;
+    BLATable bla; // only touched by the worker thread
+    BLATable staging_bla;
+
+    // secondary references placed inside glitches, computed whenever no main orbit is waiting. they have their own
+    // generation so that giving up on a correction doesn't abort the main orbit, a new main orbit aborts them too
+    std::atomic<uint64_t> secondary_generation = 0;
+    std::condition_variable secondary_cv;
+    bool secondary_pending = false;
+    bool secondary_requested = false; // from the request until the orbit is staged or given up on
+    Job secondary_job;
+    ReferenceOrbit secondary; // only touched by the worker thread
+    bool secondary_ready = false;
+    OrbitData staging_secondary;
+
+    // the last nucleus search, only touched by the worker thread
+    MPC searched{256};
+    floatexp searched_radius = 0.0;
+    int searched_iters = 0;
+    MPC nucleus{256};
+    int nucleus_period = 0;
+
+    std::thread thread;
+
+    // finds the lowest period nucleus within the search radius, returns false if there is none
+    bool locate_nucleus(const Job& j, const CancelToken& token) {
+        if (j.prec == searched.get_prec() && j.max_iters == searched_iters && searched_radius > 0.0) {
+            // a region within the one searched last can't hold a lower period, so its nucleus still is the lowest
+            // as long as it is inside. this is what keeps zooming in from searching again at every step
+            ScratchMPC offset(j.prec);
+            *offset = j.center;
+            *offset -= searched;
+            if (magnitude(*offset) + j.nucleus_radius <= searched_radius) {
+                if (nucleus_period == 0) return false;
+                *offset = nucleus;
+                *offset -= j.center;
+                if (magnitude(*offset) <= j.nucleus_radius) return true;
+            }
+        }
+        std::string key = nucleus_cache_key(j.center, j.prec, j.nucleus_radius, j.max_iters);
+        if (j.cache && load_nucleus_cache(key, j.prec, nucleus, nucleus_period)) {
+            searched = j.center;
+            searched.change_prec(j.prec);
+            searched_radius = j.nucleus_radius;
+            searched_iters = j.max_iters;
+            return nucleus_period > 0;
+        }
+        auto start = std::chrono::steady_clock::now();
+        nucleus = j.center;
+        nucleus.change_prec(j.prec);
+        nucleus_period = find_period(nucleus, j.nucleus_radius, j.max_iters, token);
+        if (nucleus_period > 0 && !find_nucleus(nucleus, nucleus_period, token))
+            nucleus_period = 0;
+        if (nucleus_period > 0) {
+            // newton can wander off to a nucleus of the same period outside the view
+            ScratchMPC offset(j.prec);
+            *offset = nucleus;
+            *offset -= j.center;
+            if (magnitude(*offset) > j.nucleus_radius) nucleus_period = 0;
+        }
+        if (token.cancelled()) return false;
+        searched = j.center;
+        searched.change_prec(j.prec);
+        searched_radius = j.nucleus_radius;
+        searched_iters = j.max_iters;
+        if (j.cache && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= orbit_cache_min_seconds)
+            store_nucleus_cache(key, nucleus, nucleus_period);
+        return nucleus_period > 0;
+    }
+
+    void run_secondary(const Job& j, uint64_t id) {
+        CancelToken token{ &secondary_generation, id };
+        // update() has nothing to do for the same point as last time, its orbit is still there
+        secondary.update(j.center, j.prec, j.max_iters, j.formula, false, token, &j.julia);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!token.cancelled()) {
+            staging_secondary = secondary.data;
+            secondary_ready = true;
+        }
+        if (!secondary_pending) secondary_requested = false;
+        secondary_cv.notify_all();
+    }
+
+    void run() {
+        Job j;
+        while (true) {
+            uint64_t id;
+            bool main;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return pending || secondary_pending || stop; });
+                if (stop) return;
+                // the main orbit goes first, the view can't be corrected against a reference it doesn't have yet
+                main = pending;
+                const Job& next = main ? job : secondary_job;
+                j.center = next.center;
+                j.prec = next.prec;
+                j.max_iters = next.max_iters;
+                j.formula = next.formula;
+                j.julia = next.julia;
+                j.terms = next.terms;
+                j.radius = next.radius;
+                j.bla = next.bla;
+                j.compress = next.compress;
+                j.nucleus_radius = next.nucleus_radius;
+                j.cache = next.cache;
+                if (main) {
+                    // busy before the lock is released, or working() would see neither for a moment
+                    id = generation.load();
+                    pending = false;
+                    busy = true;
+                }
+                else {
+                    id = secondary_generation.load();
+                    secondary_pending = false;
+                }
+            }
+            if (!main) {
+                run_secondary(j, id);
+                continue;
+            }
+            CancelToken token{ &generation, id };
+            // the orbit of a nucleus returns to 0 after one period, pixels rebase instead of needing the rest
+            bool at_nucleus = j.nucleus_radius > 0.0 && locate_nucleus(j, token);
+            const MPC& point = at_nucleus ? nucleus : j.center;
+            int iters = at_nucleus ? std::min(j.max_iters, nucleus_period) : j.max_iters;
+            // a cached orbit that is too short is extended from its last iterate like any other
+            bool from_cache = j.cache && !token.cancelled() && !reference.current(point, j.prec, iters, j.formula, j.compress, &j.julia)
+                && load_orbit_cache(point, j.prec, j.formula, j.compress, &j.julia, reference, series, bla);
+            bool computed = reference.update(point, j.prec, iters, j.formula, j.compress, token, &j.julia);
+            bool unpublished = reference.prec != staged_prec || reference.center != staged_center || reference.addend != staged_addend ||
+                reference.data.length != staged_length || reference.data.formula != staged_formula || reference.data.compressed != staged_compressed;
+            bool changed = computed || from_cache || unpublished;
+            reference.data.period = at_nucleus ? nucleus_period : 0;
+            if (!token.cancelled()) {
+                // pixels are further from a nucleus than from the center, the approximations have to cover them
+                double radius = j.radius;
+                if (at_nucleus && radius > 0.0) {
+                    ScratchMPC offset(j.prec);
+                    *offset = nucleus;
+                    *offset -= j.center;
+                    radius = exp2(ceil(log2(radius + magnitude(*offset).to_double())));
+                }
+                // the coefficients depend on the view radius too, so they can change without the orbit
+                bool series_changed = j.terms > 0 && (changed || radius != series.radius || j.terms != static_cast<int>(series.coefficients.size()));
+                bool series_cached = from_cache && !computed && radius == series.radius && j.terms == static_cast<int>(series.coefficients.size());
+                if (series_changed && !series_cached)
+                    series = compute_series(reference.data, j.terms, radius);
+                bool bla_changed = j.bla && (changed || radius != bla.radius || bla.entries.empty());
+                bool bla_cached = from_cache && !computed && radius == bla.radius && !bla.entries.empty();
+                if (bla_changed && !bla_cached)
+                    bla = compute_bla(reference.data, radius);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (changed) {
+                        bool extends = reference.prec == staged_prec && reference.center == staged_center && reference.addend == staged_addend &&
+                            reference.data.length >= staged_length && reference.data.formula == staged_formula && reference.data.compressed == staged_compressed;
+                        // the GL thread may not have taken the previous one yet
+                        staging_extends = extends && (staging_extends || !ready);
+                        staging = reference.data;
+                        staging_center = reference.center;
+                        ready = true;
+                        staged_center = reference.center;
+                        staged_addend = reference.addend;
+                        staged_prec = reference.prec;
+                        staged_length = reference.data.length;
+                        staged_formula = reference.data.formula;
+                        staged_compressed = reference.data.compressed;
+                    }
+                    if (series_changed) {
+                        staging_series = series;
+                        series_ready = true;
+                    }
+                    if (bla_changed) {
+                        staging_bla = bla;
+                        bla_ready = true;
+                    }
+                }
+                // an extended entry is rewritten however long the extension took, the entry itself was slow
+                if (j.cache && computed && (from_cache || reference.seconds >= orbit_cache_min_seconds))
+                    store_orbit_cache(reference, j.terms > 0 ? &series : nullptr, j.bla ? &bla : nullptr);
+            }
+            busy = false;
+        }
+    }
+public:
+    ReferenceWorker() {
+        thread = std::thread(&ReferenceWorker::run, this);
+    }
+    ~ReferenceWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+            generation++;
+            secondary_generation++;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+
+    // cheap to call every frame, a new computation is only started when something has changed
+    void request(const MPC& c, mpfr_prec_t p, int iters, const OrbitFormula& formula, const MPC& julia, int terms = 0, double radius = 0.0, bool use_bla = false, bool compress = false, floatexp nucleus_radius = 0.0, bool cache = false) {
+        if (c == requested.center && p == requested.prec && iters == requested.max_iters && formula == requested.formula && julia == requested.julia && terms == requested.terms && radius == requested.radius && use_bla == requested.bla && compress == requested.compress && nucleus_radius == requested.nucleus_radius && cache == requested.cache) return;
+        requested.center = c;
+        requested.prec = p;
+        requested.max_iters = iters;
+        requested.formula = formula;
+        requested.julia = julia;
+        requested.terms = terms;
+        requested.radius = radius;
+        requested.bla = use_bla;
+        requested.compress = compress;
+        requested.nucleus_radius = nucleus_radius;
+        requested.cache = cache;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job.center = c;
+            job.prec = p;
+            job.max_iters = iters;
+            job.formula = formula;
+            job.julia = julia;
+            job.terms = terms;
+            job.radius = radius;
+            job.bla = use_bla;
+            job.compress = compress;
+            job.nucleus_radius = nucleus_radius;
+            job.cache = cache;
+            pending = true;
+            generation++; // aborts the computation in progress
+            secondary_generation++; // and the secondary references of the view it belonged to
+            secondary_pending = false;
+            secondary_requested = false;
+            secondary_ready = false;
+        }
+        cv.notify_one();
+        secondary_cv.notify_all();
+    }
+
+    // starts computing a secondary reference for glitch correction, replacing the one in progress
+    void request_secondary(const MPC& c, mpfr_prec_t p, int iters, const OrbitFormula& formula, const MPC& julia) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            secondary_job.center = c;
+            secondary_job.prec = p;
+            secondary_job.max_iters = iters;
+            secondary_job.formula = formula;
+            secondary_job.julia = julia;
+            secondary_pending = true;
+            secondary_requested = true;
+            secondary_ready = false;
+            secondary_generation++;
+        }
+        cv.notify_one();
+    }
+
+    // gives up on the secondary reference in progress
+    void cancel_secondary() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!secondary_requested) return;
+        secondary_generation++;
+        secondary_pending = false;
+        secondary_requested = false;
+        secondary_ready = false;
+    }
+
+    // moves the finished secondary reference into orbit. with wait it blocks until the worker is done with it,
+    // false if there is none or it was given up on
+    bool poll_secondary(OrbitData& orbit, bool wait) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (wait) secondary_cv.wait(lock, [&] { return secondary_ready || !secondary_requested; });
+        if (!secondary_ready) return false;
+        std::swap(orbit, staging_secondary);
+        secondary_ready = false;
+        secondary_requested = false;
+        return true;
+    }
+
+    // moves a newly finished orbit into the arguments, returns false if there is none. extended is set if it
+    // is the previous orbit with more iterations
+    bool poll(OrbitData& orbit, MPC& center, bool& extended) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ready) return false;
+        std::swap(orbit, staging);
+        center = staging_center;
+        extended = staging_extends;
+        ready = false;
+        return true;
+    }
+
+    // same for the series approximation of the latest orbit
+    bool poll_series(SeriesApproximation& sa) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!series_ready) return false;
+        std::swap(sa, staging_series);
+        series_ready = false;
+        return true;
+    }
+
+    bool poll_bla(BLATable& table) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!bla_ready) return false;
+        std::swap(table, staging_bla);
+        bla_ready = false;
+        return true;
+    }
+
+    bool working() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return busy || pending;
+    }
+};
+
+// .mvl location files: this header followed by the center as base 16 text
+struct LocationHeader {
+    char magic[4];
+    uint32_t version;
+    double zoom_mantissa;
+    int64_t zoom_exponent;
+    int64_t prec;
+    uint64_t center_size;
+};
+
+constexpr char location_magic[4] = { 'M', 'V', 'L', '2' };
+constexpr uint32_t location_version = 1;
+
+static void save_location(const std::filesystem::path& path, const MPC& center, const floatexp& zoom) {
+    std::ofstream fout;
+    fout.open(path, std::ios::binary | std::ios::out | std::ofstream::trunc);
+    LocationHeader h = {};
+    std::memcpy(h.magic, location_magic, 4);
+    h.version = location_version;
+    h.zoom_mantissa = zoom.m;
+    h.zoom_exponent = zoom.e;
+    h.prec = center.get_prec();
+    std::string digits = center.hex(); // every bit, so the location and its cached orbits come back exactly
+    h.center_size = digits.size();
+    fout.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    fout.write(digits.data(), digits.size());
+    fout.close();
+}
+
+constexpr double floatexp_threshold = 1e-150; // below this zoom the perturbation deltas are kept as floatexp
+constexpr int precision_margin = 32; // bits kept beyond the pixel spacing, the reference orbit loses some as it goes
 constexpr double zoom_co = 0.85; // the number the zoom amount is multiplied with with each mouse scroll
 constexpr double doubleClick_interval = 0.4; // maximum time in seconds in which two consecutive mouse clicks is considered a double click
+constexpr int compute_tile_size = 128; // side of the tiles the compute pass is drawn in, in framebuffer pixels
+constexpr size_t pixel_state_size = 80; // PixelState in render.glsl, four dvec2 and four ints
+constexpr int coarsest_subdivision = 32; // spacing of the first lines the subdivision computes, the same as in render.glsl
+constexpr int kernel_workgroups = 256; // workgroups of 64 the compute kernel keeps running, each pulling pixels off the queue
+constexpr int kernel_tiles = 8; // tiles handed to one dispatch of the compute kernel
+constexpr double single_spacing = 3e-5; // pixel spacing relative to the coordinates above which floats are enough, about 256 ulps
 ivec2 monitorSize;
 
+// finds targets for zoom videos by descending from a view towards smaller and smaller minibrots until one is as
+// deep as requested. each step splits the view into a grid of boxes, looks for the lowest period nucleus of every
+// box on all cores and moves to one of them, halfway in scale to its minibrot so the next step sees the
+// structure around it
+class AutoNavigator {
+public:
+    struct Target {
+        MPC center{64};
+        floatexp zoom = 0.0;
+        int period = 0;
+        uint32_t seed = 0;
+    };
+    struct Progress {
+        int target = 0; // index in the batch
+        int step = 0;
+        int period = 0;
+        floatexp zoom = 0.0;
+    };
+private:
+    static constexpr int grid = 4; // boxes per side
+    static constexpr int max_depth = 3; // times a box is split when it only finds what was visited already
+    static constexpr int max_steps = 1000;
+    static constexpr int max_period = 1 << 20;
+    static constexpr int choices = 3; // the lowest periods a seed picks from, seed 0 always takes the lowest
+    static constexpr double framing = 8.0; // view width of the final target in minibrot sizes
+
+    struct Candidate {
+        MPC nucleus{64};
+        int period = 0;
+        floatexp size = 0.0;
+    };
+
+    std::mutex mutex;
+    std::atomic<uint64_t> generation = 0;
+    std::atomic<bool> busy = false;
+    std::atomic<int> failures = 0;
+    std::vector<Target> finished;
+    Progress status;
+    std::thread thread;
+
+    // enough bits to place a nucleus within a minibrot of the given size
+    static mpfr_prec_t precision_for(const floatexp& size) {
+        double bits = -size.log2() + precision_margin;
+        return std::max<mpfr_prec_t>(64, static_cast<mpfr_prec_t>(ceil(bits / 64.0)) * 64);
+    }
+
+    // the lowest period nucleus within radius of c and the size of its minibrot, 0 as the period if there is none
+    static Candidate evaluate(const MPC& c, const floatexp& radius, int max_iters, const CancelToken& token) {
+        Candidate result;
+        result.nucleus = c;
+        result.period = find_period(c, radius, max_iters, token);
+        if (result.period == 0 || !find_nucleus(result.nucleus, result.period, token)) {
+            result.period = 0;
+            return result;
+        }
+        result.size = minibrot_size(result.nucleus, result.period, token);
+        // the search precision follows the view, a much smaller minibrot needs its nucleus refined
+        mpfr_prec_t p = precision_for(result.size);
+        if (result.size.m != 0.0 && p > result.nucleus.get_prec()) {
+            result.nucleus.change_prec(p);
+            if (!find_nucleus(result.nucleus, result.period, token)) result.period = 0;
+            else result.size = minibrot_size(result.nucleus, result.period, token);
+        }
+        if (result.size.m == 0.0) result.period = 0;
+        return result;
+    }
+
+    // nuclei of a higher period than the last one within the view, one per box of the grid. boxes that only
+    // see the structure already visited are split up to max_depth times to look past it. the boxes are shared
+    // out to a thread per core
+    static std::vector<Candidate> survey(const MPC& c, const floatexp& radius, int period, const CancelToken& token) {
+        struct Box {
+            dvec2 offset; // of the box center, in view radii
+            int level;
+        };
+        std::vector<Box> boxes;
+        for (int i = 0; i < grid * grid; i++)
+            boxes.push_back({ dvec2((i % grid) * 2 + 1 - grid, (i / grid) * 2 + 1 - grid) / static_cast<double>(grid), 0 });
+        std::vector<Candidate> found;
+        std::mutex lock;
+        std::condition_variable cv;
+        int active = 0;
+        // bounded by the period, interior points never settle on 0 and would run to the limit
+        int max_iters = std::min(max_period, std::max(1024, period * 64));
+
+        auto work = [&] {
+            std::unique_lock<std::mutex> guard(lock);
+            while (true) {
+                cv.wait(guard, [&] { return !boxes.empty() || active == 0; });
+                if (boxes.empty() || token.cancelled()) break;
+                Box box = boxes.back();
+                boxes.pop_back();
+                active++;
+                guard.unlock();
+
+                floatexp half = radius / (grid * std::exp2(box.level));
+                ScratchMPC center(c.get_prec());
+                *center = c;
+                center->add_scaled(box.offset * radius.m, radius.e);
+                // the disk around the box center has to cover its corners
+                Candidate candidate = evaluate(*center, half * std::sqrt(2.0), max_iters, token);
+                bool valid = candidate.period > period && candidate.size < radius;
+                if (valid) {
+                    // newton can leave the box, even the view
+                    ScratchMPC offset(std::max(c.get_prec(), candidate.nucleus.get_prec()));
+                    *offset = candidate.nucleus;
+                    *offset -= c;
+                    valid = magnitude(*offset) <= radius * std::sqrt(2.0);
+                }
+
+                guard.lock();
+                if (valid) found.push_back(std::move(candidate));
+                else if (candidate.period > 0 && box.level < max_depth) {
+                    double quarter = 1.0 / (grid * std::exp2(box.level + 1));
+                    for (int i = 0; i < 4; i++)
+                        boxes.push_back({ box.offset + dvec2(i & 1 ? quarter : -quarter, i & 2 ? quarter : -quarter), box.level + 1 });
+                }
+                active--;
+                cv.notify_all();
+            }
+            cv.notify_all();
+        };
+        int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++)
+            pool.emplace_back(work);
+        work();
+        for (auto& t : pool) t.join();
+        return found;
+    }
+
+    bool descend(const MPC& start, floatexp zoom, floatexp depth, uint32_t seed, int index, Target& target, const CancelToken& token) {
+        std::mt19937 rng(seed);
+        MPC c = start;
+        floatexp radius = zoom * 0.5;
+        int period = 0;
+        for (int step = 0; step < max_steps && !token.cancelled(); step++) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                status = { index, step, period, radius * 2.0 };
+            }
+            // the minibrots in view are usually around the square of its radius
+            mpfr_prec_t p = precision_for(radius * radius);
+            if (p > c.get_prec()) c.change_prec(p);
+            std::vector<Candidate> candidates = survey(c, radius, period, token);
+            if (token.cancelled()) return false;
+
+            std::vector<const Candidate*> valid;
+            for (const Candidate& candidate : candidates)
+                valid.push_back(&candidate);
+            if (valid.empty()) return false;
+            std::sort(valid.begin(), valid.end(), [](const Candidate* a, const Candidate* b) {
+                return a->period < b->period || (a->period == b->period && a->size > b->size);
+            });
+            valid.erase(std::unique(valid.begin(), valid.end(), [](const Candidate* a, const Candidate* b) {
+                return a->period == b->period;
+            }), valid.end());
+
+            // the first minibrot that is already deep enough ends the descent
+            for (const Candidate* candidate : valid) {
+                if (candidate->size * framing > depth) continue;
+                target.center = candidate->nucleus;
+                target.zoom = candidate->size * framing;
+                target.period = candidate->period;
+                target.seed = seed;
+                return true;
+            }
+            int pick = seed == 0 ? 0 : std::uniform_int_distribution<int>(0, std::min<int>(choices, valid.size()) - 1)(rng);
+            const Candidate& next = *valid[pick];
+            c = next.nucleus;
+            period = next.period;
+            radius = pow(radius * next.size, 0.5);
+        }
+        return false;
+    }
+public:
+    ~AutoNavigator() {
+        cancel();
+    }
+
+    // looks for count targets below the view, each one from its own seed
+    void start(const MPC& center, floatexp zoom, floatexp depth, uint32_t seed, int count = 1) {
+        cancel();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.clear();
+            status = {};
+        }
+        failures = 0;
+        busy = true;
+        CancelToken token{ &generation, generation.load() };
+        thread = std::thread([this, center, zoom, depth, seed, count, token] {
+            for (int i = 0; i < count && !token.cancelled(); i++) {
+                Target target;
+                if (descend(center, zoom, depth, seed + i, i, target, token)) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    finished.push_back(std::move(target));
+                }
+                else if (!token.cancelled()) failures++;
+            }
+            busy = false;
+        });
+    }
+
+    void cancel() {
+        generation++;
+        if (thread.joinable()) thread.join();
+        busy = false;
+    }
+
+    // moves the next finished target into the argument, returns false if there is none
+    bool poll(Target& target) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finished.empty()) return false;
+        target = std::move(finished.front());
+        finished.erase(finished.begin());
+        return true;
+    }
+
+    Progress progress() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return status;
+    }
+
+    int failed() const {
+        return failures;
+    }
+
+    bool running() const {
+        return busy;
+    }
+};
+
 struct Slider {
     std::string name;
     double def = 0.f; // default value
@@ -541,10 +2378,307 @@ struct Fractal {
     bool continuous_compatible = true; // whether the continuous coloring algorithm works for this fractal
     bool julia_compatible = true; // whether a julia version of this fractal exists
     bool hflip = false, vflip = false; // whether the fractal should be horizontally or vertically flipped by default (e.g burning ship fractal)
+    std::string perturbation = "dvec2(0.0)"; // next delta d from the reference Z and the offset dc of the pixel (must be of type dvec2)
+    ReferenceFormula reference = ReferenceFormula::None; // how the reference orbit is computed, None if perturbation isn't supported
 
     std::vector<Slider> sliders;
 };
 
+// whether a bailout only waits for z to escape. convergent fractals test for z getting close to something,
+// and an orbit settling into a cycle there is what they are looking for
+static bool escape_bailout(const std::string& condition) {
+    return condition.find('<') == std::string::npos;
+}
+
+// an equation or bailout with its doubles turned into floats, for the single precision loop in render.glsl
+static std::string single_precision(std::string str) {
+    str = std::regex_replace(str, std::regex("\\bdvec2\\b"), "vec2");
+    str = std::regex_replace(str, std::regex("\\bdouble\\b"), "float");
+    return std::regex_replace(str, std::regex("(\\d)(LF|lf)\\b"), "$1");
+}
+
+// an equation or bailout rewritten for the float-float loop in render.glsl. glsl has no operator overloading, so
+// the expression is parsed and every operation on doubles becomes a call to the df_ and dfc_ functions there.
+// returns an empty string for anything it doesn't know, which leaves the fractal without the emulated loop
+class EmulatedDouble {
+public:
+    static std::string translate(const std::string& expr, bool condition) {
+        EmulatedDouble parser(expr);
+        try {
+            Value v = parser.logical();
+            if (parser.pos != parser.tokens.size()) return "";
+            if (condition) return v.type == Type::Bool ? v.code : "";
+            return v.type == Type::Bool ? "" : parser.complex(v);
+        } catch (std::exception& e) {
+            return "";
+        }
+    }
+
+private:
+    enum class Type { Bool, Int, Float, Real, Complex }; // a real is one float-float, a complex number two
+    struct Value {
+        std::string code;
+        Type type;
+    };
+
+    std::vector<std::string> tokens;
+    size_t pos = 0;
+
+    EmulatedDouble(const std::string& expr) {
+        for (size_t i = 0; i < expr.size();) {
+            size_t start = i;
+            if (isspace(expr[i])) {
+                i++;
+                continue;
+            }
+            if (isdigit(expr[i]) || (expr[i] == '.' && i + 1 < expr.size() && isdigit(expr[i + 1]))) {
+                while (i < expr.size() && (isalnum(expr[i]) || expr[i] == '.' ||
+                    ((expr[i] == '+' || expr[i] == '-') && tolower(expr[i - 1]) == 'e')))
+                    i++;
+            }
+            else if (isalpha(expr[i]) || expr[i] == '_') {
+                while (i < expr.size() && (isalnum(expr[i]) || expr[i] == '_')) i++;
+            }
+            else if (expr.compare(i, 2, "||") == 0 || expr.compare(i, 2, "&&") == 0 || expr.compare(i, 2, "==") == 0 ||
+                expr.compare(i, 2, "!=") == 0 || expr.compare(i, 2, "<=") == 0 || expr.compare(i, 2, ">=") == 0) {
+                i += 2;
+            }
+            else i++;
+            tokens.push_back(expr.substr(start, i - start));
+        }
+    }
+
+    std::string peek() const {
+        return pos < tokens.size() ? tokens[pos] : "";
+    }
+    std::string next() {
+        if (pos == tokens.size()) throw std::runtime_error("Unexpected end of expression");
+        return tokens[pos++];
+    }
+    void expect(const std::string& token) {
+        if (next() != token) throw std::runtime_error("Expected " + token);
+    }
+
+    bool scalar(const Value& v) const {
+        return v.type == Type::Int || v.type == Type::Float;
+    }
+    std::string real(const Value& v) const {
+        switch (v.type) {
+        case Type::Int:   return std::format("vec2(float({}), 0.f)", v.code);
+        case Type::Float: return std::format("vec2({}, 0.f)", v.code);
+        case Type::Real:  return v.code;
+        default: throw std::runtime_error("Expected a real number");
+        }
+    }
+    // a real used with a dvec2 applies to both components, as it does with doubles
+    std::string complex(const Value& v) const {
+        if (v.type == Type::Complex) return v.code;
+        return std::format("({}).xyxy", real(v));
+    }
+    // comparisons only look at the high part
+    std::string single(const Value& v) const {
+        switch (v.type) {
+        case Type::Int:   return std::format("float({})", v.code);
+        case Type::Float: return v.code;
+        case Type::Real:  return std::format("({}).x", v.code);
+        default: throw std::runtime_error("Expected a real number");
+        }
+    }
+
+    Value logical() {
+        Value a = comparison();
+        while (peek() == "||" || peek() == "&&") {
+            std::string op = next();
+            Value b = comparison();
+            if (a.type != Type::Bool || b.type != Type::Bool) throw std::runtime_error("Expected a bool");
+            a = { std::format("({} {} {})", a.code, op, b.code), Type::Bool };
+        }
+        return a;
+    }
+    Value comparison() {
+        Value a = sum();
+        for (const char* op : { "<", ">", "<=", ">=", "==", "!=" }) {
+            if (peek() != op) continue;
+            next();
+            Value b = sum();
+            return { std::format("({} {} {})", single(a), op, single(b)), Type::Bool };
+        }
+        return a;
+    }
+    Value sum() {
+        Value a = product();
+        while (peek() == "+" || peek() == "-") {
+            std::string op = next();
+            a = arithmetic(op[0], a, product());
+        }
+        return a;
+    }
+    Value product() {
+        Value a = unary();
+        while (peek() == "*" || peek() == "/") {
+            std::string op = next();
+            a = arithmetic(op[0], a, unary());
+        }
+        return a;
+    }
+    Value arithmetic(char op, const Value& a, const Value& b) {
+        if (a.type == Type::Bool || b.type == Type::Bool) throw std::runtime_error("Arithmetic on a bool");
+        if (scalar(a) && scalar(b))
+            return { std::format("({} {} {})", a.code, op, b.code), a.type == Type::Int && b.type == Type::Int ? Type::Int : Type::Float };
+        const char* name = op == '+' ? "add" : op == '-' ? "sub" : op == '*' ? "mul" : "div";
+        if (a.type == Type::Complex || b.type == Type::Complex) {
+            const char* dfc = op == '+' ? "add" : op == '-' ? "sub" : op == '*' ? "scale" : "shrink";
+            return { std::format("dfc_{}({}, {})", dfc, complex(a), complex(b)), Type::Complex };
+        }
+        return { std::format("df_{}({}, {})", name, real(a), real(b)), Type::Real };
+    }
+    Value unary() {
+        if (peek() == "+") {
+            next();
+            return unary();
+        }
+        if (peek() == "-") {
+            next();
+            Value v = unary();
+            if (v.type == Type::Bool) throw std::runtime_error("Negating a bool");
+            return { std::format("(-{})", v.code), v.type };
+        }
+        if (peek() == "!") {
+            next();
+            Value v = unary();
+            if (v.type != Type::Bool) throw std::runtime_error("Expected a bool");
+            return { std::format("(!{})", v.code), Type::Bool };
+        }
+        return postfix();
+    }
+    Value postfix() {
+        Value v = primary();
+        while (peek() == ".") {
+            next();
+            std::string member = next();
+            if (v.type != Type::Complex || (member != "x" && member != "y")) throw std::runtime_error("Unknown member " + member);
+            v = { std::format("({}).{}", v.code, member == "x" ? "xy" : "zw"), Type::Real };
+        }
+        return v;
+    }
+    Value primary() {
+        std::string token = next();
+        if (token == "(") {
+            Value v = logical();
+            expect(")");
+            return { std::format("({})", v.code), v.type };
+        }
+        if (isdigit(token[0]) || token[0] == '.')
+            return number(token);
+        if (peek() == "(") {
+            next();
+            std::vector<Value> args;
+            while (peek() != ")") {
+                args.push_back(logical());
+                if (peek() == ",") next();
+                else break;
+            }
+            expect(")");
+            return call(token, args);
+        }
+        if (token == "z" || token == "c" || token == "prevz")
+            return { token, Type::Complex };
+        if (token == "xsq" || token == "ysq")
+            return { token, Type::Real };
+        if (token == "i" || token == "max_iters")
+            return { token, Type::Int };
+        if (token == "power" || token == "time")
+            return { token, Type::Float };
+        if (token == "sliders") {
+            expect("[");
+            Value index = sum();
+            expect("]");
+            if (index.type != Type::Int) throw std::runtime_error("Expected an int");
+            return { std::format("sliders[{}]", index.code), Type::Float };
+        }
+        if (token == "zoom" || token == "M_PI" || token == "M_2PI" || token == "M_PI2" || token == "M_E" || token == "M_EHALF")
+            return { std::format("df_from({})", token), Type::Real };
+        if (token == "center" || token == "mouseCoord" || token == "initialz")
+            return { std::format("dfc_from({})", token), Type::Complex };
+        throw std::runtime_error("Unknown identifier " + token);
+    }
+    // literals are floats in glsl unless they end in lf, those are split into a high and a low part
+    Value number(std::string token) {
+        bool is_double = token.ends_with("lf") || token.ends_with("LF");
+        bool is_float = is_double || token.find_first_of(".eEfF") != std::string::npos;
+        while (isalpha(token.back()) && tolower(token.back()) != 'e') token.pop_back();
+        if (!is_float) return { token, Type::Int };
+        double value = std::stod(token);
+        float hi = static_cast<float>(value), lo = is_double ? static_cast<float>(value - hi) : 0.f;
+        auto literal = [](float f) {
+            std::string s = std::format("{}", f);
+            return s.find_first_of(".e") == std::string::npos ? s + ".f" : s;
+        };
+        if (lo == 0.f) return { literal(hi), Type::Float };
+        return { std::format("vec2({}, {})", literal(hi), literal(lo)), Type::Real };
+    }
+    Value call(const std::string& name, const std::vector<Value>& args) {
+        auto arity = [&](size_t n) {
+            if (args.size() != n) throw std::runtime_error("Wrong number of arguments to " + name);
+        };
+        if (name == "cmultiply" || name == "cdivide") {
+            arity(2);
+            return { std::format("dfc_{}({}, {})", name, complex(args[0]), complex(args[1])), Type::Complex };
+        }
+        if (name == "cconj" || name == "cexp" || name == "clog" || name == "csin" || name == "ccos" || name == "csqrt") {
+            arity(1);
+            return { std::format("dfc_{}({})", name, complex(args[0])), Type::Complex };
+        }
+        if (name == "carg") {
+            arity(1);
+            return { std::format("dfc_carg({})", complex(args[0])), Type::Real };
+        }
+        if (name == "cpow") {
+            arity(2);
+            if (args[1].type == Type::Complex)
+                return { std::format("dfc_cpow({}, {})", complex(args[0]), args[1].code), Type::Complex };
+            return { std::format("dfc_cpow({}, {})", complex(args[0]), single(args[1])), Type::Complex };
+        }
+        if (name == "length" || name == "distance") {
+            if (name == "distance") arity(2);
+            else arity(1);
+            std::string z = name == "length" ? complex(args[0]) : std::format("dfc_sub({}, {})", complex(args[0]), complex(args[1]));
+            return { std::format("dfc_length({})", z), Type::Real };
+        }
+        if (name == "dvec2" || name == "vec2") {
+            if (args.size() == 1) return { complex(args[0]), Type::Complex };
+            arity(2);
+            return { std::format("vec4({}, {})", real(args[0]), real(args[1])), Type::Complex };
+        }
+        if (name == "double" || name == "float") {
+            arity(1);
+            if (args[0].type == Type::Int) return { std::format("float({})", args[0].code), Type::Float };
+            real(args[0]);
+            return args[0];
+        }
+        if (name == "abs" || name == "sqrt") {
+            arity(1);
+            if (scalar(args[0])) return { std::format("{}({})", name, single(args[0])), Type::Float };
+            return { std::format("df_{}({})", name, real(args[0])), Type::Real };
+        }
+        // the rest only keep float accuracy
+        std::string function = name == "atan2" ? "atan" : name;
+        if (function.starts_with("d")) function.erase(0, 1); // dsin, dcos, dexp, dlog and dpow
+        if ((function != "sin" && function != "cos" && function != "exp" && function != "log" && function != "pow" &&
+            function != "atan") || args.empty() || args.size() > 2)
+            throw std::runtime_error("Unknown function " + name);
+        std::string code = function + "(" + single(args[0]);
+        bool exact = scalar(args[0]);
+        if (args.size() == 2) {
+            code += ", " + single(args[1]);
+            exact = exact && scalar(args[1]);
+        }
+        code += ")";
+        if (exact) return { code, Type::Float };
+        return { std::format("vec2({}, 0.f)", code), Type::Real };
+    }
+};
+
 std::vector<Fractal> fractals = {
     Fractal({.name = "Custom"}),
     Fractal({.name = "Hybrid"}),
@@ -555,6 +2689,8 @@ std::vector<Fractal> fractals = {
         .power = 2.f,
         .continuous_compatible = true,
         .julia_compatible = true,
+        .perturbation = "binomial(Z, d) + dc",
+        .reference = ReferenceFormula::Mandelbrot,
     }),
     Fractal({.name = "Julia Set",
         .equation = "cpow(z, power) + dvec2(Re, Im)",
@@ -563,6 +2699,8 @@ std::vector<Fractal> fractals = {
         .power = 2.f,
         .continuous_compatible = true,
         .julia_compatible = false,
+        .perturbation = "binomial(Z, d)",
+        .reference = ReferenceFormula::Julia,
         .sliders = { Slider("Re", 0.f), Slider("Im", 0.f) }
     }),
     Fractal({.name = "Nova",
@@ -581,6 +2719,8 @@ std::vector<Fractal> fractals = {
         .continuous_compatible = true,
         .julia_compatible = true,
         .vflip = true, // most images of the burning ship fractal in the internet are actually flipped vertically such that the imaginary axis increases downwards
+        .perturbation = "ship_delta(Z, d) + dc",
+        .reference = ReferenceFormula::BurningShip,
     }),
     Fractal({.name = "Newton",
         .equation = "z - cmultiply(dvec2(Re, Im), cdivide(cpow(z, power) - dvec2(1.f, 0.f), power * cpow(z, power - 1.f)))",
@@ -622,6 +2762,8 @@ std::vector<Fractal> fractals = {
         .power = 2.f,
         .continuous_compatible = true,
         .julia_compatible = true,
+        .perturbation = "cconj(binomial(Z, d)) + dc",
+        .reference = ReferenceFormula::Tricorn,
     }),
     Fractal({.name = "Feather",
         .equation = "cmultiply(cpow(z, 2.f), cdivide(z, dvec2(1.0 + z.x * z.x, z.y * z.y))) + c",
@@ -644,7 +2786,7 @@ std::vector<Fractal> fractals = {
 struct Config {
     MPC    center{"-0.4", 256};
     ivec2  frameSize = { 1200, 800 };
-    double zoom = 5.0; // width of a pixel in the complex plane
+    floatexp zoom = 5.0; // width of a pixel in the complex plane
     float  theta = 0.f; // rotation angle in degrees (converted to radians when passing to the shader)
     bool   vflip = false; // vertical flip
     bool   hflip = false; // horizontal flip
@@ -659,9 +2801,27 @@ struct Config {
     int    transfer_function = 0; // 0: linear, 1: square root, 2: cubic root, 3: logarithmic
     double power = 1.f;
     bool   perturbation = false;
+    bool   auto_prec = true; // derive the precision from the zoom instead of the precision slider
     bool   series_approx = false;
     int    num_terms = 3;
+    bool   bla = true; // bivariate linear approximation
+    bool   compress_orbit = false; // store only waypoints of the reference orbit and recompute the rest on the gpu
+    bool   nucleus_reference = false; // move the reference to the lowest period nucleus in view, its orbit is one period long
+    bool   orbit_cache = true; // keep slow reference orbits on disk for when the same location comes up again
     bool   cardioid_check = true;
+    bool   periodicity_check = true; // stop iterating orbits that have settled into a cycle
+    bool   subdivision = true; // mariani-silver, fill blocks whose border is entirely in the set without iterating them
+    int    batch_size = 8; // iterations between bailout checks when not perturbing, 0, 8 or 16
+    bool   single_precision = true; // iterate in floats while the view is shallow enough for them
+    bool   emulated_double = false; // iterate in pairs of floats instead of doubles, for gpus that are slow at doubles
+    bool   rebasing = true; // restart pixels at the beginning of the reference orbit instead of letting them glitch
+    bool   glitch_correction = true;
+    int    max_references = 16; // extra reference orbits per frame used to fix glitched pixels
+    int    frame_budget = 30; // milliseconds of computing per frame before the rest of the tiles wait for the next one, 0 for whole frames
+    bool   resume_iterations = false; // keep where unfinished pixels stopped so a higher iteration limit only continues them
+    int    iteration_chunk = 0; // iterations per pass while resuming, a larger limit is reached over several passes. 0 for all at once
+    bool   compute_kernel = false; // iterate with persistent compute workgroups pulling pixels off a queue instead of the fragment pass
+    bool   cost_ordering = false; // queue the pixels of each tile by the iterations they took in the last pass
     // normal mapping
     float  angle = 180.f; // angle of the incoming light (not perfectly accurate)
     float  height = 1.5f; // height of the light source, changes how well pronounced the normal map effect is
@@ -673,6 +2833,7 @@ struct ZoomVideoConfig {
     int duration = 30;
     int direction = 0;
     char path[256]{};
+    floatexp end_zoom = 0.0; // the zoom the video reaches at tcfg.center
 
     bool ease_inout = true;
 };
@@ -695,6 +2856,12 @@ class MV2 {
 
     Config config;
     ZoomVideoConfig zvc;
+    AutoNavigator navigator;
+    char target_depth[32] = "1e-100";
+    bool target_depth_invalid = false; // the last search was refused because the depth didn't parse
+    int target_count = 1;
+    uint32_t target_seed = 0; // every search starts from the next one, so searching again finds another target
+    std::filesystem::path target_folder; // where a batch of targets is saved, empty for a single one
     AVIWriter writer;
 
     mpfr_prec_t prec = 256;
@@ -713,6 +2880,29 @@ class MV2 {
     bool sync_zoom_julia = true;
     
     int zoomTowards = 1; // 0: center, 1: cursor
+
+    // the compute pass is drawn in tiles, nearest to where the zoom goes first, so that a slow frame doesn't
+    // freeze the ui. the partial result is shown in between, and the tiles left over are dropped when the view changes
+    std::vector<ivec4> compute_tiles;
+    size_t next_tile = 0;
+    bool tiles_stale = true;
+    double pixel_ms = 0.0; // milliseconds per pixel the last batch of tiles took, 0 before the first one
+    int64_t batch_pixels = 0; // pixels in the last batch, the next one grows to at most four times as many
+
+    int pass_limit = 0; // iteration limit of the compute pass in progress
+    bool storing_state = false; // the pass in progress keeps where unfinished pixels stopped
+    int state_iters = 0; // the limit the stored pixels stopped at, 0 if they don't belong to the current view
+    bool resume_requested = false; // only the iteration limit went up since the last pass
+    bool subdividing = false; // the pass in progress computes the tiles line by line, see render.glsl
+    bool kernel_pass = false; // the pass in progress runs on the compute kernel
+    bool single_available = false; // the equation and bailout of the current shader work in floats
+    bool single_pass = false; // the pass in progress iterates in floats
+    bool emulated_available = false; // the equation and bailout of the current shader could be rewritten in float-float
+    bool emulated_pass = false; // the pass in progress iterates in float-float
+    bool kernel_stale = true; // the kernel has to be built again from the current shader
+    std::vector<size_t> tile_queue; // where the pixels of each tile start in the work queue, followed by its end
+    double pass_time = 0.0; // milliseconds the pass in progress has spent computing so far
+    double last_pass_time = 0.0;
     bool juliaset = true;
     bool orbit = true;
     bool audio = false;
@@ -727,7 +2917,8 @@ class MV2 {
     bool dragging = false;
     bool rightClickHold = false;
     MPC tempCenter{256};
-    double tempZoom = config.zoom;
+    MPC julia_constant{64}; // constant of the julia set preset, at full precision when it comes from a double click
+    floatexp tempZoom = config.zoom;
     float zoom_sensitivity = 1.0;
 
     bool startup_anim_complete = false;
@@ -742,6 +2933,14 @@ class MV2 {
     int progress = 0;
 
     GLuint shaderProgram = 0;
+    GLuint kernelProgram = 0; // render.glsl built as a compute shader, 0 if that failed
+    // the uniforms the kernel copies from shaderProgram, looked up once when the kernel is built
+    struct KernelUniform {
+        GLint from, to;
+        GLenum type;
+    };
+    std::vector<KernelUniform> kernel_uniforms;
+    GLint kernel_queue_end = -1;
     GLuint vertexShader = 0;
 
     GLuint computeFrameBuffer = 0;
@@ -755,6 +2954,7 @@ class MV2 {
     GLuint juliaTexBuffer = 0;
     GLuint prevFrameTexBuffer = 0;
     GLuint accIndexTexBuffer = 0;
+    GLuint glitchMaskTexBuffer = 0;
 
     GLuint paletteBuffer = 0;
     GLuint orbitInBuffer = 0;
@@ -763,7 +2963,29 @@ class MV2 {
     GLuint kernelBuffer = 0;
 
     GLuint referenceBuffer = 0;
+    GLuint referenceBackBuffer = 0; // the next orbit is uploaded here while the previous one is still in use
     GLuint coeffBuffer = 0;
+    GLuint blaBuffer = 0;
+    GLuint waypointBuffer = 0;
+    GLuint stateBuffer = 0;
+    size_t state_buffer_size = 0;
+    GLuint queueBuffer = 0;
+
+    ReferenceWorker ref_worker;
+    OrbitData ref_orbit;
+    MPC ref_center{256};
+    int reforbit_size = 0;
+    SeriesApproximation series;
+    BLATable bla_table;
+    int sa_skip = 0; // what the shader currently uses, both are turned off for glitch passes
+    int bla_levels = 0;
+    bool reference_uniforms_stale = false; // a new shader program starts without the uniforms of the reference
+
+    GLuint glitchReferenceBuffer = 0;
+    int glitch_references = 0; // secondary references used for the last computed frame
+    int glitched_pixels = 0; // pixels still flagged after the last correction pass
+    ivec2 glitch_pixel = { -1, -1 }; // where the secondary reference the worker is computing goes, x < 0 when no correction is under way
+    MPC glitch_point{64};
 
     int32_t stateID = 10;
     ImGradientHDRState state;
@@ -934,6 +3156,13 @@ public:
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glBindImageTexture(4, accIndexTexBuffer, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32F);
 
+        glGenTextures(1, &glitchMaskTexBuffer);
+        glBindTexture(GL_TEXTURE_2D, glitchMaskTexBuffer);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, config.frameSize.x * config.ssaa, config.frameSize.y * config.ssaa, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindImageTexture(5, glitchMaskTexBuffer, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+
         glGenTextures(1, &juliaTexBuffer);
         glBindTexture(GL_TEXTURE_2D, juliaTexBuffer);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, julia_size * config.ssaa, julia_size * config.ssaa, 0, GL_RGB, GL_FLOAT, NULL);
@@ -972,18 +3201,13 @@ public:
         const char* content;
         size_t length;
 
-        unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        GLuint fragmentShader = 0;
         embed = b::embed<"shaders/render.glsl">();
         content = embed.data();
         length = embed.length();
         
-        char* modifiedSource = new char[length + 4096];
-        sprintf(modifiedSource, content, fractals[fractal].equation.data(), fractals[fractal].condition.data(), fractals[fractal].initialz.data(), fractals[fractal].condition.data(), fractals[fractal].initialz.data());
-        glShaderSource(fragmentShader, 1, &modifiedSource, NULL);
-        glCompileShader(fragmentShader);
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+        compile_shader(fragmentShader, &success, infoLog, content, length);
         if (!success) {
-            glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
             std::cout << infoLog << std::endl;
             return;
         }
@@ -995,7 +3219,6 @@ public:
         glLinkProgram(shaderProgram);
         std::cout << "link\n";
         glDeleteShader(fragmentShader);
-        delete[] modifiedSource;
 
         unsigned int VBO, VAO;
         glGenVertexArrays(1, &VAO);
@@ -1044,15 +3267,36 @@ public:
         upload_kernel(config.ssaa);
 
         glGenBuffers(1, &referenceBuffer);
+        glGenBuffers(1, &referenceBackBuffer);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, referenceBuffer);
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, referenceBuffer);
         glShaderStorageBlockBinding(shaderProgram, glGetProgramResourceIndex(shaderProgram, GL_SHADER_STORAGE_BLOCK, "reference_orbit"), 5);
+        glGenBuffers(1, &glitchReferenceBuffer);
 
         glGenBuffers(1, &coeffBuffer);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, coeffBuffer);
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, coeffBuffer);
         glShaderStorageBlockBinding(shaderProgram, glGetProgramResourceIndex(shaderProgram, GL_SHADER_STORAGE_BLOCK, "coefficients"), 6);
 
+        glGenBuffers(1, &blaBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, blaBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, blaBuffer);
+        glShaderStorageBlockBinding(shaderProgram, glGetProgramResourceIndex(shaderProgram, GL_SHADER_STORAGE_BLOCK, "bla_table"), 7);
+
+        glGenBuffers(1, &waypointBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, waypointBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, waypointBuffer);
+        glShaderStorageBlockBinding(shaderProgram, glGetProgramResourceIndex(shaderProgram, GL_SHADER_STORAGE_BLOCK, "reference_waypoints"), 8);
+
+        glGenBuffers(1, &stateBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, stateBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, stateBuffer);
+        glShaderStorageBlockBinding(shaderProgram, glGetProgramResourceIndex(shaderProgram, GL_SHADER_STORAGE_BLOCK, "pixel_states"), 9);
+
+        glGenBuffers(1, &queueBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, queueBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, queueBuffer);
+
         use_config(config, true, false);
         on_windowResize(window, config.frameSize.x * dpi_scale, config.frameSize.y * dpi_scale);
 
@@ -1088,7 +3332,7 @@ private:
             glUniform1i(glGetUniformLocation(shaderProgram, "hflip"), config.hflip);
             glUniform1i(glGetUniformLocation(shaderProgram, "vflip"), config.vflip);
             glUniform1f(glGetUniformLocation(shaderProgram, "iter_multiplier"), config.iter_multiplier);
-            glUniform1d(glGetUniformLocation(shaderProgram, "zoom"), config.zoom);
+            upload_zoom(config.zoom);
             glUniform1i(glGetUniformLocation(shaderProgram, "max_iters"), config.max_iters);
             glUniform1f(glGetUniformLocation(shaderProgram, "spectrum_offset"), config.spectrum_offset);
             glUniform1i(glGetUniformLocation(shaderProgram, "continuous_coloring"), config.continuous_coloring);
@@ -1101,6 +3345,11 @@ private:
             glUniform1i(glGetUniformLocation(shaderProgram, "perturbation"), config.perturbation);
             glUniform1i(glGetUniformLocation(shaderProgram, "series_approx"), config.series_approx);
             glUniform1i(glGetUniformLocation(shaderProgram, "cardioid_check"), config.cardioid_check);
+            glUniform1i(glGetUniformLocation(shaderProgram, "periodicity"), config.periodicity_check && escape_bailout(fractals[fractal].condition));
+            glUniform1i(glGetUniformLocation(shaderProgram, "batch_size"), config.batch_size);
+            glUniform1i(glGetUniformLocation(shaderProgram, "reforbit_size"), reforbit_size);
+            glUniform1i(glGetUniformLocation(shaderProgram, "rebasing"), config.rebasing);
+            glUniform1i(glGetUniformLocation(shaderProgram, "glitch_detection"), config.glitch_correction);
 
             glUniform1i(glGetUniformLocation(shaderProgram, "show_orbit"), false);
             glUniform2i(glGetUniformLocation(shaderProgram, "orbit_start"), -1, -1);
@@ -1129,9 +3378,65 @@ private:
 
             glBindTexture(GL_TEXTURE_2D, accIndexTexBuffer);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, config.frameSize.x * config.ssaa, config.frameSize.y * config.ssaa, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+
+            glBindTexture(GL_TEXTURE_2D, glitchMaskTexBuffer);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, config.frameSize.x * config.ssaa, config.frameSize.y * config.ssaa, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
         }
     }
 
+    void upload_zoom(const floatexp& zoom) {
+        glUniform1d(glGetUniformLocation(shaderProgram, "zoom"), zoom.to_double());
+        // the perturbation path rebuilds the zoom from these once it gets too small for a double
+        glUniform1d(glGetUniformLocation(shaderProgram, "zoom_mantissa"), zoom.m);
+        glUniform1i(glGetUniformLocation(shaderProgram, "zoom_exponent"), zoom.e);
+    }
+
+    // the binomial expansion needs an integer power, the burning ship formula is only written for squares
+    bool perturbation_available() const {
+        ReferenceFormula kind = fractals[fractal].reference;
+        if (kind == ReferenceFormula::None) return false;
+        if (kind == ReferenceFormula::BurningShip) return config.power == 2.0;
+        return config.power == round(config.power) && config.power >= 2.0 && config.power <= 5.0;
+    }
+
+    OrbitFormula orbit_formula() const {
+        OrbitFormula formula{ fractals[fractal].reference, static_cast<int>(config.power) };
+        if (formula.kind == ReferenceFormula::Julia) {
+            formula.julia = julia_constant;
+        }
+        return formula;
+    }
+
+    // julia orbits need every bit of their constant, however shallow the julia view is
+    mpfr_prec_t reference_precision(const OrbitFormula& formula) const {
+        return formula.kind == ReferenceFormula::Julia ? std::max(prec, julia_constant.get_prec()) : prec;
+    }
+
+    // enough bits to tell neighbouring pixels of a width pixels wide frame apart, with the integer part and
+    // a margin on top. rounded up to whole limbs so that zooming doesn't restart the orbit at every step
+    static mpfr_prec_t required_precision(const floatexp& zoom, int width) {
+        double bits = std::log2(static_cast<double>(width)) - zoom.log2() + 2 + precision_margin;
+        return std::max<mpfr_prec_t>(64, static_cast<mpfr_prec_t>(ceil(bits / 64.0)) * 64);
+    }
+
+    void set_prec(mpfr_prec_t p) {
+        prec = p;
+        // the automatic precision never drops digits of the center, zooming back in has to land on the same spot
+        if (!config.auto_prec || prec > config.center.get_prec()) config.center.change_prec(prec);
+        // a video can end somewhere other than the view, at a target found for it
+        const MPC& center = recording ? zvc.tcfg.center : config.center;
+        glUniform2d(glGetUniformLocation(shaderProgram, "center"), center.real(), center.imag());
+        set_op(MV_COMPUTE);
+    }
+
+    // center minus the point the reference was computed for, also relative to the zoom's exponent for the floatexp path
+    void upload_ref_offset(const MPC& center, const MPC& reference, const floatexp& zoom) {
+        dvec2 offset = scaled_difference(center, reference, 0);
+        glUniform2d(glGetUniformLocation(shaderProgram, "ref_offset"), offset.x, offset.y);
+        dvec2 scaled = scaled_difference(center, reference, zoom.e);
+        glUniform2d(glGetUniformLocation(shaderProgram, "ref_offset_scaled"), scaled.x, scaled.y);
+    }
+
     void set_op(int p, bool override = false) {
         if (config.taa) {
             if ((p == MV_COMPUTE || p == MV_POSTPROC) && !override) {
@@ -1141,6 +3446,157 @@ private:
             p = MV_COMPUTE;
         }
         if (p > op || override) op = p;
+        if (p == MV_COMPUTE) {
+            tiles_stale = true;
+            resume_requested = false;
+            // the glitches belong to the pass that is being replaced
+            if (glitch_pixel.x >= 0) {
+                glitch_pixel = { -1, -1 };
+                ref_worker.cancel_secondary();
+            }
+        }
+    }
+
+    // splits a size pixels large compute pass into tiles ordered by their distance to focus
+    void plan_compute_tiles(ivec2 size, dvec2 focus, bool whole) {
+        compute_tiles.clear();
+        next_tile = 0;
+        if (whole) {
+            compute_tiles.push_back(ivec4(0, 0, size.x, size.y));
+            return;
+        }
+        for (int y = 0; y < size.y; y += compute_tile_size)
+            for (int x = 0; x < size.x; x += compute_tile_size)
+                compute_tiles.push_back(ivec4(x, y, std::min(compute_tile_size, size.x - x), std::min(compute_tile_size, size.y - y)));
+        auto distance = [focus](const ivec4& t) {
+            dvec2 d = dvec2(t.x + t.z * 0.5, t.y + t.w * 0.5) - focus;
+            return dot(d, d);
+        };
+        std::stable_sort(compute_tiles.begin(), compute_tiles.end(), [&](const ivec4& a, const ivec4& b) {
+            return distance(a) < distance(b);
+        });
+    }
+
+    // lists the pixels of every tile in the work queue of the compute kernel. with cost ordering the pixels of a tile
+    // are grouped by the iterations they took in the last pass, so invocations that run side by side finish together
+    void queue_compute_tiles(ivec2 size) {
+        std::vector<float> iterations;
+        GLint width = 0, height = 0;
+        glGetTextureLevelParameteriv(computeTexBuffer, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTextureLevelParameteriv(computeTexBuffer, 0, GL_TEXTURE_HEIGHT, &height);
+        if (config.cost_ordering && width == size.x && height == size.y) {
+            iterations.resize(static_cast<size_t>(size.x) * size.y);
+            glGetTextureImage(computeTexBuffer, 0, GL_GREEN, GL_FLOAT, iterations.size() * sizeof(float), iterations.data());
+        }
+        // eighths of an octave of iterations, the pixels that were in the set last
+        auto cost = [&](uint32_t pixel) {
+            float i = iterations[pixel];
+            return i < 0.f ? 255 : std::min(254, static_cast<int>(std::log2(i + 1.f) * 8.f));
+        };
+
+        std::vector<uint32_t> queue, tile;
+        tile_queue.clear();
+        for (const ivec4& t : compute_tiles) {
+            size_t first = queue.size();
+            tile_queue.push_back(first);
+            for (int y = t.y; y < t.y + t.w; y++)
+                for (int x = t.x; x < t.x + t.z; x++)
+                    queue.push_back(static_cast<uint32_t>(y) * size.x + x);
+            if (iterations.empty()) continue;
+            // counting sort, which keeps the pixels of a bucket in scanline order
+            std::vector<size_t> bucket(257, 0);
+            for (size_t k = first; k < queue.size(); k++) bucket[cost(queue[k]) + 1]++;
+            for (int b = 0; b < 256; b++) bucket[b + 1] += bucket[b];
+            tile.resize(queue.size() - first);
+            for (size_t k = first; k < queue.size(); k++) tile[bucket[cost(queue[k])]++] = queue[k];
+            std::copy(tile.begin(), tile.end(), queue.begin() + first);
+        }
+        tile_queue.push_back(queue.size());
+        // the first word is the head of the queue, set before each dispatch
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, queueBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, (queue.size() + 1) * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(uint32_t), queue.size() * sizeof(uint32_t), queue.data());
+    }
+
+    // draws the tiles from next_tile up to last
+    void draw_tile_batch(size_t last) {
+        while (next_tile < last) {
+            if (kernel_pass) {
+                // a tile alone is too few pixels to keep every workgroup busy until the queue runs dry
+                size_t end = std::min(last, next_tile + kernel_tiles);
+                uint32_t head = static_cast<uint32_t>(tile_queue[next_tile]);
+                glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(uint32_t), &head);
+                glUniform1ui(kernel_queue_end, static_cast<GLuint>(tile_queue[end]));
+                glDispatchCompute(kernel_workgroups, 1, 1);
+                glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+                next_tile = end;
+            }
+            else {
+                const ivec4& t = compute_tiles[next_tile++];
+                glScissor(t.x, t.y, t.z, t.w);
+                if (subdividing) {
+                    // the tiles are made of whole blocks, so each one can go through all the passes on its own. the
+                    // blocks along the far edges are bounded by the first lines of the next tiles, which are computed twice
+                    for (int spacing = coarsest_subdivision; spacing >= 1; spacing /= 2) {
+                        int edge = spacing == coarsest_subdivision ? 1 : 0;
+                        glScissor(t.x, t.y, t.z + edge, t.w + edge);
+                        glUniform1i(glGetUniformLocation(shaderProgram, "subdivision"), spacing);
+                        glDrawArrays(GL_TRIANGLES, 0, 6);
+                        // the next pass reads the lines this one wrote
+                        glTextureBarrier();
+                    }
+                    glUniform1i(glGetUniformLocation(shaderProgram, "subdivision"), 0);
+                }
+                else glDrawArrays(GL_TRIANGLES, 0, 6);
+            }
+        }
+    }
+
+    // draws tiles until budget milliseconds have passed, at least one. true once the last one is drawn. the tiles go
+    // in batches sized from how fast the last one went, and only the end of each batch is waited for
+    bool draw_compute_tiles(int budget) {
+        auto start = std::chrono::steady_clock::now();
+        if (kernel_pass) {
+            glUseProgram(kernelProgram);
+            sync_kernel_uniforms();
+            glBindImageTexture(6, computeTexBuffer, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, queueBuffer);
+        }
+        else glEnable(GL_SCISSOR_TEST);
+        while (next_tile < compute_tiles.size()) {
+            if (budget <= 0) {
+                draw_tile_batch(compute_tiles.size());
+                break;
+            }
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            // as many tiles as the rest of the budget should take at the last speed, the first one alone before that is known
+            int64_t fit = pixel_ms > 0.0 ? static_cast<int64_t>((budget - elapsed) / pixel_ms) : 0;
+            fit = std::min(fit, batch_pixels * 4);
+            size_t last = next_tile;
+            int64_t pixels = 0;
+            do {
+                pixels += static_cast<int64_t>(compute_tiles[last].z) * compute_tiles[last].w;
+                last++;
+            } while (last < compute_tiles.size() && pixels + static_cast<int64_t>(compute_tiles[last].z) * compute_tiles[last].w <= fit);
+            auto batch_start = std::chrono::steady_clock::now();
+            draw_tile_batch(last);
+            // the draws are only queued, waiting for the batch keeps the queue from running past the budget
+            GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            auto now = std::chrono::steady_clock::now();
+            pixel_ms = std::chrono::duration<double, std::milli>(now - batch_start).count() / pixels;
+            batch_pixels = pixels;
+            if (std::chrono::duration<double, std::milli>(now - start).count() >= budget) break;
+        }
+        if (kernel_pass) glUseProgram(shaderProgram);
+        else glDisable(GL_SCISSOR_TEST);
+        bool done = next_tile == compute_tiles.size();
+        // waiting for the last tile makes the time of a pass comparable between the fragment pass and the kernel
+        if (done) glFinish();
+        pass_time += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (done) last_pass_time = pass_time;
+        return done;
     }
 
     static dvec2 cmultiply(dvec2 a, dvec2 b) {
@@ -1150,34 +3606,157 @@ private:
         return dvec2((a.x * b.x + a.y * b.y), (a.y * b.x - a.x * b.y)) / (b.x * b.x + b.y * b.y);
     }
 
+    // out = center + v * scale without going through a double, which would underflow at deep zooms.
+    // out may be center itself
+    static void offset_center(MPC& out, const MPC& center, dvec2 v, const floatexp& scale) {
+        out = center;
+        out.add_scaled(v * scale.m, scale.e);
+    }
+    // (a - b) / 2^exponent
+    static dvec2 scaled_difference(const MPC& a, const MPC& b, int64_t exponent) {
+        ScratchMPC difference(std::max(a.get_prec(), b.get_prec()));
+        mpc_sub(difference->value, a.value, b.value, MPC_RNDNN);
+        mpc_mul_2si(difference->value, difference->value, -exponent, MPC_RNDNN);
+        return *difference;
+    }
+
     MPC pixel_to_complex(dvec2 pixelCoord) {
+        MPC result(config.center.get_prec());
         ivec2 ss = (fullscreen ? monitorSize : config.frameSize);
-
-        return config.center + cmultiply(((dvec2(pixelCoord.x / ss.x, (ss.y - pixelCoord.y) / ss.y)) - dvec2(0.5, 0.5)) *
-            dvec2(config.zoom, (ss.y * config.zoom) / ss.x), dvec2(cos(config.theta * M_PI / 180.f), sin(config.theta * M_PI / 180.f))) * dvec2(config.hflip ? -1.0 : 1.0, config.vflip ? -1.0 : 1.0);
+        pixel_to_complex(result, pixelCoord, ss, config.zoom, config.center, config.theta, config.hflip, config.vflip);
+        return result;
     }
-    static MPC pixel_to_complex(dvec2 pixelCoord, ivec2 ss, double zoom, MPC center, float theta, bool hflip, bool vflip) {
-        return center + cmultiply(((dvec2(pixelCoord.x / ss.x, (ss.y - pixelCoord.y) / ss.y)) - dvec2(0.5, 0.5)) *
-            dvec2(zoom, (ss.y * zoom) / ss.x), dvec2(cos(theta * M_PI / 180.f), sin(theta * M_PI / 180.f))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
+    // for callers that only need doubles, every frame or from the audio thread
+    dvec2 pixel_to_dvec2(dvec2 pixelCoord) {
+        ScratchMPC result(config.center.get_prec());
+        ivec2 ss = (fullscreen ? monitorSize : config.frameSize);
+        pixel_to_complex(*result, pixelCoord, ss, config.zoom, config.center, config.theta, config.hflip, config.vflip);
+        return *result;
+    }
+    static MPC pixel_to_complex(dvec2 pixelCoord, ivec2 ss, floatexp zoom, const MPC& center, float theta, bool hflip, bool vflip) {
+        MPC result(center.get_prec());
+        pixel_to_complex(result, pixelCoord, ss, zoom, center, theta, hflip, vflip);
+        return result;
+    }
+    static void pixel_to_complex(MPC& out, dvec2 pixelCoord, ivec2 ss, floatexp zoom, const MPC& center, float theta, bool hflip, bool vflip) {
+        offset_center(out, center, cmultiply(((dvec2(pixelCoord.x / ss.x, (ss.y - pixelCoord.y) / ss.y)) - dvec2(0.5, 0.5)) *
+            dvec2(1.0, static_cast<double>(ss.y) / ss.x), dvec2(cos(theta * M_PI / 180.f), sin(theta * M_PI / 180.f))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0), zoom);
     }
     
-    dvec2 complex_to_pixel(MPC complexCoord) {
+    dvec2 complex_to_pixel(const MPC& complexCoord) {
         ivec2 ss = (fullscreen ? monitorSize : config.frameSize);
-
-        complexCoord = config.center + cmultiply(complexCoord - config.center, dvec2(cos(config.theta * M_PI / 180.f), -sin(config.theta * M_PI / 180.f))) * dvec2(config.hflip ? -1.0 : 1.0, config.vflip ? -1.0 : 1.0);
-        dvec2 normalizedCoord = (complexCoord - config.center);
-        normalizedCoord /= dvec2(config.zoom, (ss.y * config.zoom) / ss.x);
-        dvec2 pixelCoordNormalized = normalizedCoord + dvec2(0.5, 0.5);
-        return dvec2(pixelCoordNormalized.x * ss.x, ss.y - pixelCoordNormalized.y * ss.y);
+        return complex_to_pixel(complexCoord, ss, config.zoom, config.center, config.theta, config.hflip, config.vflip);
     }
-    static dvec2 complex_to_pixel(MPC complexCoord, ivec2 ss, double zoom, MPC center, float theta, bool hflip, bool vflip) {
-        complexCoord = center + cmultiply(complexCoord - center, dvec2(cos(theta * M_PI / 180.f), -sin(theta * M_PI / 180.f))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
-        dvec2 normalizedCoord = (complexCoord - center);
-        normalizedCoord /= dvec2(zoom, (ss.y * zoom) / ss.x);
+    static dvec2 complex_to_pixel(const MPC& complexCoord, ivec2 ss, floatexp zoom, const MPC& center, float theta, bool hflip, bool vflip) {
+        dvec2 normalizedCoord = cmultiply(scaled_difference(complexCoord, center, zoom.e) / zoom.m, dvec2(cos(theta * M_PI / 180.f), -sin(theta * M_PI / 180.f))) * dvec2(hflip ? -1.0 : 1.0, vflip ? -1.0 : 1.0);
+        normalizedCoord /= dvec2(1.0, static_cast<double>(ss.y) / ss.x);
         dvec2 pixelCoordNormalized = normalizedCoord + dvec2(0.5, 0.5);
         return dvec2(pixelCoordNormalized.x * ss.x, ss.y - pixelCoordNormalized.y * ss.y);
     }
 
+    // picks a pixel near the middle of the largest connected glitch, { -1, -1 } if nothing is flagged
+    static ivec2 find_glitch_reference(const std::vector<uint32_t>& mask, int w, int h, int& count) {
+        std::vector<int> label(mask.size(), -1);
+        std::vector<int> stack;
+        int best = -1;
+        int best_size = 0;
+        dvec2 best_centroid;
+        count = 0;
+        for (int start = 0; start < mask.size(); start++) {
+            if (!mask[start] || label[start] != -1) continue;
+            int size = 0;
+            dvec2 sum(0.0);
+            label[start] = start;
+            stack.push_back(start);
+            while (!stack.empty()) {
+                int p = stack.back();
+                stack.pop_back();
+                int x = p % w, y = p / w;
+                size++;
+                sum += dvec2(x, y);
+                auto visit = [&](int q) {
+                    if (mask[q] && label[q] == -1) {
+                        label[q] = start;
+                        stack.push_back(q);
+                    }
+                };
+                if (x > 0)     visit(p - 1);
+                if (x < w - 1) visit(p + 1);
+                if (y > 0)     visit(p - w);
+                if (y < h - 1) visit(p + w);
+            }
+            count += size;
+            if (size > best_size) {
+                best = start;
+                best_size = size;
+                best_centroid = sum / static_cast<double>(size);
+            }
+        }
+        if (best == -1) return { -1, -1 };
+
+        // the centroid of a ring shaped glitch isn't part of it, so take the closest pixel that is
+        ivec2 closest = { -1, -1 };
+        double min_dist = INFINITY;
+        for (int p = 0; p < mask.size(); p++) {
+            if (label[p] != best) continue;
+            dvec2 v = dvec2(p % w, p / w) - best_centroid;
+            if (v.x * v.x + v.y * v.y < min_dist) {
+                min_dist = v.x * v.x + v.y * v.y;
+                closest = { p % w, p / w };
+            }
+        }
+        return closest;
+    }
+
+    // looks for the largest glitch left and has the worker compute a secondary reference inside it, ends the
+    // correction once there is none or the limit is reached
+    void next_glitch(const Config& cfg) {
+        GLint w, h;
+        glGetTextureLevelParameteriv(glitchMaskTexBuffer, 0, GL_TEXTURE_WIDTH, &w);
+        glGetTextureLevelParameteriv(glitchMaskTexBuffer, 0, GL_TEXTURE_HEIGHT, &h);
+        std::vector<uint32_t> mask(w * h);
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        glGetTextureImage(glitchMaskTexBuffer, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, mask.size() * sizeof(uint32_t), mask.data());
+        glitch_pixel = find_glitch_reference(mask, w, h, glitched_pixels);
+        if (glitch_pixel.x < 0 || glitch_references >= cfg.max_references) {
+            glitch_pixel = { -1, -1 };
+            return;
+        }
+        glitch_point = pixel_to_complex(dvec2(glitch_pixel.x + 0.5, h - (glitch_pixel.y + 0.5)), ivec2(w, h), cfg.zoom, cfg.center, cfg.theta, cfg.hflip, cfg.vflip);
+        ref_worker.request_secondary(glitch_point, reference_precision(ref_orbit.formula), cfg.max_iters, ref_orbit.formula, julia_constant);
+    }
+
+    // re-renders the pixels flagged by the compute pass against the secondary references as the worker finishes
+    // them, one glitch after another. video frames wait for all of them
+    void correct_glitches(const Config& cfg, bool wait) {
+        OrbitData secondary;
+        while (glitch_pixel.x >= 0 && ref_worker.poll_secondary(secondary, wait)) {
+            glUniform1i(glGetUniformLocation(shaderProgram, "glitch_pass"), true);
+            // the coefficients and the bla table belong to the main reference
+            glUniform1i(glGetUniformLocation(shaderProgram, "sa_skip"), 0);
+            glUniform1i(glGetUniformLocation(shaderProgram, "bla_levels"), 0);
+            glUniform1i(glGetUniformLocation(shaderProgram, "ref_compressed"), false); // secondary orbits are short, they are stored in full
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, glitchReferenceBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, glitchReferenceBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, secondary.orbit.size() * sizeof(dvec2), secondary.orbit.data(), GL_DYNAMIC_COPY);
+            glUniform1i(glGetUniformLocation(shaderProgram, "reforbit_size"), secondary.length);
+            upload_ref_offset(cfg.center, glitch_point, cfg.zoom);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            glitch_references++;
+
+            glUniform1i(glGetUniformLocation(shaderProgram, "glitch_pass"), false);
+            glUniform1i(glGetUniformLocation(shaderProgram, "sa_skip"), sa_skip);
+            glUniform1i(glGetUniformLocation(shaderProgram, "bla_levels"), bla_levels);
+            glUniform1i(glGetUniformLocation(shaderProgram, "ref_compressed"), ref_orbit.compressed);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, referenceBuffer);
+            glUniform1i(glGetUniformLocation(shaderProgram, "reforbit_size"), reforbit_size);
+            upload_ref_offset(cfg.center, ref_center, cfg.zoom);
+            next_glitch(cfg);
+        }
+        // the worker gave up on it, the view has changed
+        if (glitch_pixel.x >= 0 && wait) glitch_pixel = { -1, -1 };
+    }
+
     // https://stackoverflow.com/a/8204886/15514474
     static std::vector<float> generate_kernel(int radius) {  
         auto gaussian = [](float x, float mu, float sigma) -> float {
@@ -1233,6 +3812,9 @@ private:
 
         glBindTexture(GL_TEXTURE_2D, app->accIndexTexBuffer);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, app->config.frameSize.x * app->config.ssaa, app->config.frameSize.y * app->config.ssaa, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+
+        glBindTexture(GL_TEXTURE_2D, app->glitchMaskTexBuffer);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width * app->config.ssaa, height * app->config.ssaa, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
     }
 
     static void on_mouseButton(GLFWwindow* window, int button, int action, int mod) {
@@ -1266,13 +3848,15 @@ private:
                     app->update_shader();
                     app->set_op(MV_COMPUTE, true);
                 };
-                if (app->rightClickHold && app->fractal == 1 && app->juliaset) {
-                    app->fractal = 2;
+                if (app->rightClickHold && app->fractal == 2 && app->juliaset) {
+                    app->fractal = 3;
                     double x, y;
                     glfwGetCursorPos(window, &x, &y);
                     x *= app->dpi_scale;
                     y *= app->dpi_scale;
-                    dvec2 cmplx = app->pixel_to_complex(dvec2(x, y));
+                    // the sliders only hold doubles, the reference orbit gets the constant with every bit of the cursor
+                    app->pixel_to_complex(app->julia_constant, dvec2(x, y), app->fullscreen ? monitorSize : app->config.frameSize, app->config.zoom, app->config.center, app->config.theta, app->config.hflip, app->config.vflip);
+                    dvec2 cmplx = app->julia_constant;
                     fractals[3].sliders[0].value = cmplx.x;
                     fractals[3].sliders[1].value = cmplx.y;
                     app->tempCenter = app->config.center;
@@ -1286,8 +3870,8 @@ private:
                         app->juliaset_disabled_incompat = true;
                     }
                 }
-                else if (app->rightClickHold && app->fractal == 2) {
-                    app->fractal = 1;
+                else if (app->rightClickHold && app->fractal == 3) {
+                    app->fractal = 2;
                     app->config.center = app->tempCenter;
                     app->config.zoom = app->tempZoom;
                     switch_shader();
@@ -1300,8 +3884,7 @@ private:
                 else {
                     glfwGetCursorPos(window, &app->oldPos.x, &app->oldPos.y);
                     app->oldPos *= app->dpi_scale;
-                    MPC pos = app->pixel_to_complex(app->oldPos);
-                    app->config.center += pos - app->config.center;
+                    app->pixel_to_complex(app->config.center, app->oldPos, app->fullscreen ? monitorSize : app->config.frameSize, app->config.zoom, app->config.center, app->config.theta, app->config.hflip, app->config.vflip);
                     glUniform2d(glGetUniformLocation(app->shaderProgram, "center"), app->config.center.real(), app->config.center.imag());
                 }
                 app->dragging = false;
@@ -1320,7 +3903,7 @@ private:
                 app->rightClickHold = true;
 
                 if (app->juliaset) {
-                    app->julia_zoom = app->sync_zoom_julia ? pow(app->config.zoom, 1.f / app->config.power) * 1.2f : 3.0;
+                    app->julia_zoom = app->sync_zoom_julia ? (pow(app->config.zoom, 1.f / app->config.power) * 1.2f).to_double() : 3.0;
                     glUniform1d(glGetUniformLocation(app->shaderProgram, "julia_zoom"), app->julia_zoom);
                     glUniform1i(glGetUniformLocation(app->shaderProgram, "julia_maxiters"), app->config.max_iters);
                 }
@@ -1361,7 +3944,7 @@ private:
         }
         if (app->dragging) {
             app->lastPresses = { -doubleClick_interval, 0 };
-            app->config.center -= cmultiply(dvec2((x - app->oldPos.x) * app->config.zoom, -(y - app->oldPos.y) * ((app->config.zoom * ss.y) / ss.x)) / dvec2(ss), dvec2(cos(app->config.theta * M_PI / 180.f), sin(app->config.theta * M_PI / 180.f))) * dvec2(app->config.hflip ? -1.0 : 1.0, app->config.vflip ? -1.0 : 1.0);
+            offset_center(app->config.center, app->config.center, -cmultiply(dvec2(x - app->oldPos.x, -(y - app->oldPos.y) * (static_cast<double>(ss.y) / ss.x)) / dvec2(ss), dvec2(cos(app->config.theta * M_PI / 180.f), sin(app->config.theta * M_PI / 180.f))) * dvec2(app->config.hflip ? -1.0 : 1.0, app->config.vflip ? -1.0 : 1.0), app->config.zoom);
             glUniform2d(glGetUniformLocation(app->shaderProgram, "center"), app->config.center.real(), app->config.center.imag());
             app->oldPos = { x, y };
             app->set_op(MV_COMPUTE);
@@ -1378,7 +3961,7 @@ private:
             app->refresh_rightclick();
         }
         else if (!ImGui::GetIO().WantCaptureMouse) {
-            double new_zoom = app->config.zoom * pow(zoom_co, y * app->zoom_sensitivity * 1.5);
+            floatexp new_zoom = app->config.zoom * pow(zoom_co, y * app->zoom_sensitivity * 1.5);
 
             if (app->zoomTowards == 1) {
                 double cursor_x, cursor_y;
@@ -1386,15 +3969,17 @@ private:
                 cursor_x *= app->dpi_scale;
                 cursor_y *= app->dpi_scale;
                 
-                dvec2 new_pos = complex_to_pixel(app->pixel_to_complex(dvec2(cursor_x, cursor_y)), app->config.frameSize, new_zoom, app->config.center, app->config.theta, app->config.hflip, app->config.vflip);
+                ScratchMPC cursor(app->config.center.get_prec());
+                pixel_to_complex(*cursor, dvec2(cursor_x, cursor_y), app->fullscreen ? monitorSize : app->config.frameSize, app->config.zoom, app->config.center, app->config.theta, app->config.hflip, app->config.vflip);
+                dvec2 new_pos = complex_to_pixel(*cursor, app->config.frameSize, new_zoom, app->config.center, app->config.theta, app->config.hflip, app->config.vflip);
 
-                app->config.center = pixel_to_complex(static_cast<dvec2>(app->config.frameSize) / 2.0 + (new_pos - dvec2(cursor_x, cursor_y)), app->config.frameSize, new_zoom, app->config.center, app->config.theta, app->config.hflip, app->config.vflip);
+                pixel_to_complex(app->config.center, static_cast<dvec2>(app->config.frameSize) / 2.0 + (new_pos - dvec2(cursor_x, cursor_y)), app->config.frameSize, new_zoom, app->config.center, app->config.theta, app->config.hflip, app->config.vflip);
                 
                 glUniform2d(glGetUniformLocation(app->shaderProgram, "center"), app->config.center.real(), app->config.center.imag());
             }
 
             app->config.zoom = new_zoom;
-            glUniform1d(glGetUniformLocation(app->shaderProgram, "zoom"), app->config.zoom);
+            app->upload_zoom(app->config.zoom);
             app->set_op(MV_COMPUTE);
             int clearValue[4] = { 1, 1, 1, 1 };
             glClearTexImage(app->accIndexTexBuffer, 0, GL_RED_INTEGER, GL_INT, clearValue);
@@ -1436,13 +4021,15 @@ private:
             
             index_repeat_new = 0;
             ready_to_copy.store(false);
+            MPC point(64);
             for (size_t i = 0; i < max_vertices + 2; i++) {
                 if (i != max_vertices + 1) {
                     if (distance(src[i], src[max_vertices + 1]) < 1e-2 && distance(src[i - 1], src[max_vertices + 1]) > 1e-2)
                         index_repeat_new = i;
                     orbit_buffer_back[i] = (vec2)src[i];
                 }
-                dst[i] = static_cast<vec2>(complex_to_pixel(MPC(src[i], 64)));
+                point = src[i];
+                dst[i] = static_cast<vec2>(complex_to_pixel(point));
                 dst[i].y = fs.y - dst[i].y;
             }
             ready_to_copy.store(true);
@@ -1458,7 +4045,9 @@ private:
         y *= dpi_scale;
         ivec2 fs = (fullscreen ? monitorSize : config.frameSize);
 
-        cmplxCoord = pixel_to_complex({ x, y });
+        ScratchMPC cursor(config.center.get_prec());
+        pixel_to_complex(*cursor, { x, y }, fs, config.zoom, config.center, config.theta, config.hflip, config.vflip);
+        cmplxCoord = *cursor;
         
         if (cmplxinfo) {
             float texel[4];
@@ -1472,6 +4061,9 @@ private:
             glBindFramebuffer(GL_FRAMEBUFFER, juliaFrameBuffer);
             glUniform1i(glGetUniformLocation(shaderProgram, "op"), 3);
             glUniform2d(glGetUniformLocation(shaderProgram, "mouseCoord"), cmplxCoord.x, cmplxCoord.y);
+            // the preview is perturbed from the reference orbit of the main view, the cursor only survives as an offset
+            dvec2 julia_dc = config.perturbation ? scaled_difference(*cursor, ref_center, 0) : dvec2(0.0);
+            glUniform2d(glGetUniformLocation(shaderProgram, "julia_dc"), julia_dc.x, julia_dc.y);
             glUniform2i(glGetUniformLocation(shaderProgram, "frameSize"), julia_size * config.ssaa, julia_size * config.ssaa);
             glDrawArrays(GL_TRIANGLES, 0, 6);
         }
@@ -1489,10 +4081,9 @@ private:
         }
     }
 
-    void compile_shader(GLuint& shader, GLint* success, char* infoLog, const char* fragmentSource, size_t length) {
-        char* modifiedSource = new char[length + 4096];
+    void compile_shader(GLuint& shader, GLint* success, char* infoLog, const char* fragmentSource, size_t length, GLenum type = GL_FRAGMENT_SHADER) {
         if (shader) glDeleteShader(shader);
-        shader = glCreateShader(GL_FRAGMENT_SHADER);
+        shader = glCreateShader(type);
 
         auto replace_variables = [&](std::string& str) {
             for (int i = 0; i < fractals[fractal].sliders.size(); i++) {
@@ -1507,6 +4098,13 @@ private:
         replace_variables(eq);
         replace_variables(cond);
         replace_variables(init);
+        std::string eq_single = single_precision(eq), cond_single = single_precision(cond);
+        std::string eq_emulated = EmulatedDouble::translate(eq, false), cond_emulated = EmulatedDouble::translate(cond, true);
+        emulated_available = !eq_emulated.empty() && !cond_emulated.empty();
+        if (!emulated_available) {
+            eq_emulated = "vec4(0.f)";
+            cond_emulated = "true";
+        }
 
         if (eq.find("mouseCoord") != std::string::npos || cond.find("mouseCoord") != std::string::npos || init.find("mouseCoord") != std::string::npos) {
             always_refresh_main = true;
@@ -1514,19 +4112,122 @@ private:
             always_refresh_main = false;
         }
 
-        sprintf(modifiedSource, fragmentSource, eq.data(), cond.data(), init.data(), cond.data(), init.data());
-        glShaderSource(shader, 1, &modifiedSource, NULL);
-        glCompileShader(shader);
-        glGetShaderiv(shader, GL_COMPILE_STATUS, success);
+        auto compile = [&]() {
+            // the equation goes in three times and the emulated copy alone is about three times as long, so the source
+            // is sized from the substitutions rather than the template
+            auto substitute = [&](char* buffer, size_t size) {
+                return snprintf(buffer, size, fragmentSource, eq.data(), cond.data(), eq_single.data(), cond_single.data(), eq_emulated.data(), cond_emulated.data(), fractals[fractal].perturbation.data(), init.data(), cond.data(), init.data());
+            };
+            std::string source(std::max(substitute(nullptr, 0), 0), '\0');
+            substitute(source.data(), source.size() + 1);
+            // the compute kernel is the same source, the define has to come after the #version line
+            if (type == GL_COMPUTE_SHADER)
+                source.insert(source.find('\n') + 1, "#define COMPUTE_KERNEL\n");
+            const char* shaderSource = source.c_str();
+            glShaderSource(shader, 1, &shaderSource, NULL);
+            glCompileShader(shader);
+            glGetShaderiv(shader, GL_COMPILE_STATUS, success);
+        };
+        // a failure is pinned on one path at a time: first the emulated loop, in case the rewrite went wrong somewhere,
+        // then the float loop, as the equation may use something that only exists for doubles, and only then both
+        std::string translated_eq = eq_emulated, translated_cond = cond_emulated;
+        auto stub_emulated = [&](bool stub) {
+            eq_emulated = stub ? "vec4(0.f)" : translated_eq;
+            cond_emulated = stub ? "true" : translated_cond;
+        };
+        single_available = true;
+        compile();
+        if (!*success && emulated_available) {
+            stub_emulated(true);
+            compile();
+            emulated_available = !*success;
+            if (!*success) stub_emulated(false);
+        }
+        if (!*success) {
+            eq_single = "vec2(0.f)";
+            cond_single = "true";
+            single_available = false;
+            compile();
+        }
+        if (!*success && emulated_available) {
+            stub_emulated(true);
+            emulated_available = false;
+            compile();
+        }
         if (!*success) {
             glGetShaderInfoLog(shader, 512, NULL, infoLog);
         }
         else infoLog[0] = '\0';
+    }
+
+    // builds render.glsl once more as a compute shader for the compute pass, kernelProgram stays 0 if that fails
+    void build_kernel() {
+        if (kernelProgram) glDeleteProgram(kernelProgram);
+        kernelProgram = 0;
+        kernel_uniforms.clear();
+        b::EmbedInternal::EmbeddedFile embed = b::embed<"shaders/render.glsl">();
+        GLuint kernel = 0;
+        GLint success;
+        char infoLog[512];
+        compile_shader(kernel, &success, infoLog, embed.data(), embed.length(), GL_COMPUTE_SHADER);
+        if (success) {
+            kernelProgram = glCreateProgram();
+            glAttachShader(kernelProgram, kernel);
+            glLinkProgram(kernelProgram);
+            glGetProgramiv(kernelProgram, GL_LINK_STATUS, &success);
+            if (!success) {
+                glGetProgramInfoLog(kernelProgram, 512, NULL, infoLog);
+                glDeleteProgram(kernelProgram);
+                kernelProgram = 0;
+            }
+        }
+        if (!success) std::cout << infoLog << std::endl;
+        glDeleteShader(kernel);
+        if (kernelProgram) cache_kernel_uniforms();
+    }
+
+    // pairs up the locations of every uniform element the kernel shares with shaderProgram
+    void cache_kernel_uniforms() {
+        kernel_queue_end = glGetUniformLocation(kernelProgram, "queue_end");
+        GLint count = 0;
+        glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint u = 0; u < count; u++) {
+            char name[256];
+            GLint size;
+            GLenum type;
+            glGetActiveUniform(shaderProgram, u, sizeof(name), NULL, &size, &type, name);
+            std::string base = name;
+            if (base.ends_with("[0]")) base.resize(base.size() - 3);
+            for (int k = 0; k < size; k++) {
+                std::string element = size > 1 ? std::format("{}[{}]", base, k) : base;
+                GLint from = glGetUniformLocation(shaderProgram, element.c_str());
+                GLint to = glGetUniformLocation(kernelProgram, element.c_str());
+                if (from >= 0 && to >= 0) kernel_uniforms.push_back({ from, to, type });
+            }
+        }
+    }
 
-        delete[] modifiedSource;
+    // every uniform is set on shaderProgram, the kernel gets a copy of the ones it uses before it runs
+    void sync_kernel_uniforms() {
+        for (const auto& [from, to, type] : kernel_uniforms) {
+            GLfloat f[4];
+            GLdouble d[4];
+            GLint i[4];
+            switch (type) {
+            case GL_FLOAT: glGetUniformfv(shaderProgram, from, f); glProgramUniform1fv(kernelProgram, to, 1, f); break;
+            case GL_FLOAT_VEC2: glGetUniformfv(shaderProgram, from, f); glProgramUniform2fv(kernelProgram, to, 1, f); break;
+            case GL_FLOAT_VEC3: glGetUniformfv(shaderProgram, from, f); glProgramUniform3fv(kernelProgram, to, 1, f); break;
+            case GL_DOUBLE: glGetUniformdv(shaderProgram, from, d); glProgramUniform1dv(kernelProgram, to, 1, d); break;
+            case GL_DOUBLE_VEC2: glGetUniformdv(shaderProgram, from, d); glProgramUniform2dv(kernelProgram, to, 1, d); break;
+            case GL_INT: case GL_BOOL: glGetUniformiv(shaderProgram, from, i); glProgramUniform1iv(kernelProgram, to, 1, i); break;
+            case GL_INT_VEC2: glGetUniformiv(shaderProgram, from, i); glProgramUniform2iv(kernelProgram, to, 1, i); break;
+            default: break; // samplers and images have their bindings in the shader
+            }
+        }
     }
 
     void reload_shader(GLuint shader) {
+        kernel_stale = true;
         glDeleteProgram(shaderProgram);
         shaderProgram = glCreateProgram();
         glAttachShader(shaderProgram, vertexShader);
@@ -1537,6 +4238,7 @@ private:
         glUseProgram(shaderProgram);
         config.normal_map_effect = false;
         use_config(config, true, false);
+        reference_uniforms_stale = true;
 
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, orbitInBuffer);
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, orbitInBuffer);
@@ -1565,11 +4267,13 @@ private:
 
     void update_shader() {
         glUniform1f(glGetUniformLocation(shaderProgram, "power"), config.power);
-        if (config.power != 2.f) {
+        if (!perturbation_available()) {
             config.perturbation = false;
+            glUniform1i(glGetUniformLocation(shaderProgram, "perturbation"), config.perturbation);
+        }
+        if (config.power != 2.f) {
             config.series_approx = false;
             config.cardioid_check = false;
-            glUniform1i(glGetUniformLocation(shaderProgram, "perturbation"), config.perturbation);
             glUniform1i(glGetUniformLocation(shaderProgram, "series_approx"), config.series_approx);
             glUniform1i(glGetUniformLocation(shaderProgram, "cardioid_check"), config.cardioid_check);
         }
@@ -1607,7 +4311,7 @@ private:
         x *= app->dpi_scale;
         y *= app->dpi_scale;
 
-        dvec2 cmplxCoord = app->pixel_to_complex({ x, y });
+        dvec2 cmplxCoord = app->pixel_to_dvec2({ x, y });
 
         for (ma_uint32 i = 0; i < frameCount; i++) {
             static float t = 0.f;
@@ -1810,6 +4514,61 @@ public:
                     ImGui::Text("%.1f GiB", static_cast<int64_t>(zvc.fps) * zvc.duration * zvc.tcfg.frameSize.x * zvc.tcfg.frameSize.y * 3.f / 1'073'741'824.f);
                     ImGui::EndChild();
 
+                    ImGui::SeparatorText("Target");
+                    ImGui::SetNextItemWidth(80);
+                    bool marked = target_depth_invalid;
+                    if (marked) ImGui::PushStyleColor(ImGuiCol_FrameBg, IM_COL32(120, 40, 40, 255));
+                    if (ImGui::InputText("Depth", target_depth, sizeof(target_depth), ImGuiInputTextFlags_CharsScientific))
+                        target_depth_invalid = false;
+                    if (marked) ImGui::PopStyleColor();
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(80);
+                    if (ImGui::InputInt("Targets", &target_count, 1, 10))
+                        target_count = std::max(target_count, 1);
+                    ImGui::SetItemTooltip("Batches of more than one target are saved to a folder as location files");
+                    if (!navigator.running()) {
+                        // the search follows Z^2 + C
+                        ImGui::BeginDisabled(!orbit_formula().quadratic());
+                        if (ImGui::Button("Find", ImVec2(90, 0))) {
+                            floatexp depth;
+                            try {
+                                depth = floatexp::parse(target_depth);
+                            } catch (std::exception& e) {
+                                depth = floatexp(0.0);
+                            }
+                            target_depth_invalid = !(depth.m > 0.0) || !std::isfinite(depth.m);
+                            target_folder.clear();
+                            if (!target_depth_invalid && target_count > 1) {
+                                const char* buf = tinyfd_selectFolderDialog("Save targets", nullptr);
+                                if (glfwGetWindowMonitor(window) != nullptr) glfwRestoreWindow(window);
+                                glfwShowWindow(window);
+                                if (buf) target_folder = buf;
+                            }
+                            if (!target_depth_invalid && (target_count == 1 || !target_folder.empty())) {
+                                navigator.start(config.center, config.zoom, depth, target_seed, target_count);
+                                target_seed += target_count;
+                            }
+                        }
+                        ImGui::EndDisabled();
+                    }
+                    else if (ImGui::Button("Stop", ImVec2(90, 0))) {
+                        navigator.cancel();
+                    }
+                    ImGui::SetItemTooltip("Descends from the view towards minibrots until one is as deep as requested");
+                    ImGui::SameLine();
+                    ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(200, 200, 200, 255));
+                    if (navigator.running()) {
+                        AutoNavigator::Progress p = navigator.progress();
+                        ImGui::Text("%d/%d: %s, period %d", p.target + 1, target_count, p.zoom.str().c_str(), p.period);
+                    }
+                    else if (target_depth_invalid)
+                        ImGui::TextColored(ImVec4(1.f, 0.45f, 0.45f, 1.f), "Not a depth, expected a positive number such as 1e-100");
+                    else if (navigator.failed() > 0)
+                        ImGui::Text("%d not found, try another view", navigator.failed());
+                    else
+                        ImGui::Text("Ends at %s", zvc.end_zoom.str().c_str());
+                    ImGui::PopStyleColor();
+
                     ImGui::Dummy(ImVec2(0.f, 4.f));
 
                     if (strlen(zvc.path) == 0 && !recording) ImGui::BeginDisabled();
@@ -1927,6 +4686,7 @@ public:
 
                 if (ImGui::Button("Create zoom video")) {
                     zvc.tcfg = config;
+                    zvc.end_zoom = config.zoom;
                     ImGui::OpenPopup("Zoom video creator");
                 }
                 ImGui::SameLine();
@@ -1960,10 +4720,34 @@ public:
                 }
                 ImGui::Text("Zoom"); ImGui::SetNextItemWidth(80); ImGui::SameLine();
                 ImGui::SetCursorPosY(ImGui::GetCursorPosY() - 3.f);
-                if (ImGui::InputDouble("##zoom", &config.zoom, 0.0, 0.0, "%.2e")) {
-                    glUniform1d(glGetUniformLocation(shaderProgram, "zoom"), config.zoom);
-                    set_op(MV_COMPUTE);
+                // a text field since the zoom can go past what InputDouble can hold
+                static char zoom_str[64];
+                // text that isn't a zoom stays in the field, marked, until it is fixed or the view zooms elsewhere
+                static bool zoom_invalid = false;
+                static floatexp rejected_zoom;
+                if (zoom_invalid && !(config.zoom == rejected_zoom)) zoom_invalid = false;
+                bool marked = zoom_invalid;
+                if (marked) ImGui::PushStyleColor(ImGuiCol_FrameBg, IM_COL32(120, 40, 40, 255));
+                if (ImGui::InputText("##zoom", zoom_str, sizeof(zoom_str), ImGuiInputTextFlags_CharsScientific | ImGuiInputTextFlags_EnterReturnsTrue)) {
+                    floatexp zoom;
+                    try {
+                        zoom = floatexp::parse(zoom_str);
+                    } catch (std::exception& e) {
+                        zoom = floatexp(0.0);
+                    }
+                    zoom_invalid = !(zoom.m > 0.0) || !std::isfinite(zoom.m);
+                    rejected_zoom = config.zoom;
+                    if (!zoom_invalid) {
+                        config.zoom = zoom;
+                        upload_zoom(config.zoom);
+                        set_op(MV_COMPUTE);
+                    }
+                }
+                if (marked) ImGui::PopStyleColor();
+                if (zoom_invalid) {
+                    ImGui::SetItemTooltip("Not a zoom, expected a positive number such as 1e-100");
                 }
+                else if (!ImGui::IsItemActive()) strcpy(zoom_str, config.zoom.str().c_str());
 
                 ImGui::SameLine();
                 ImGui::SetCursorPosY(ImGui::GetCursorPosY() - 3.f);
@@ -2051,13 +4835,8 @@ public:
                         1, lFilterPatterns, "MV2 Location File (*.mvl)");
                     if (glfwGetWindowMonitor(window) != nullptr) glfwRestoreWindow(window);
                     glfwShowWindow(window);
-                    if (buf != nullptr) {
-                        std::ofstream fout;
-                        fout.open(buf, std::ios::binary | std::ios::out | std::ofstream::trunc);
-                        //fout.write(reinterpret_cast<const char*>(value_ptr(config.center)), sizeof(dvec2));
-                        fout.write(reinterpret_cast<const char*>(&config.zoom), sizeof(double));
-                        fout.close();
-                    }
+                    if (buf != nullptr)
+                        save_location(buf, config.center, config.zoom);
                 }
                 ImGui::SameLine();
                 if (ImGui::Button("Load", ImVec2(ImGui::GetContentRegionAvail().x / 2.f - 1.f, 0))) {
@@ -2069,18 +4848,28 @@ public:
                     if (buf != nullptr) {
                         std::ifstream fin;
                         fin.open(buf, std::ios::binary | std::ios::in | std::ios::ate);
-                        int size = static_cast<int>(fin.tellg());
-                        if (size % 4 != 0 || (size /= 16) > 16) {
-                            throw Error("Palette file invalid");
-                        }
-                        paletteData.resize(size);
+                        size_t size = static_cast<size_t>(fin.tellg());
                         fin.seekg(0);
-                        //fin.read(reinterpret_cast<char*>(value_ptr(config.center)), sizeof(dvec2));
-                        fin.read(reinterpret_cast<char*>(&config.zoom), sizeof(double));
+                        if (size == sizeof(double)) {
+                            // older files only have the zoom
+                            double zoom;
+                            fin.read(reinterpret_cast<char*>(&zoom), sizeof(double));
+                            config.zoom = zoom;
+                        }
+                        else {
+                            LocationHeader h;
+                            if (size < sizeof(h) || !fin.read(reinterpret_cast<char*>(&h), sizeof(h)) || std::memcmp(h.magic, location_magic, 4) != 0
+                                || h.version != location_version || h.center_size != size - sizeof(h) || h.prec < MPFR_PREC_MIN || h.prec > MPFR_PREC_MAX) {
+                                throw Error("Location file invalid");
+                            }
+                            std::string center(h.center_size, '\0');
+                            fin.read(center.data(), center.size());
+                            config.center = MPC(center.c_str(), h.prec, 16);
+                            config.zoom = floatexp(h.zoom_mantissa, h.zoom_exponent);
+                        }
                         fin.close();
-                        //glUniform2d(glGetUniformLocation(shaderProgram, "center"), config.center.x, config.center.y);
-                        glUniform1d(glGetUniformLocation(shaderProgram, "zoom"), config.zoom);
-                        set_op(MV_COMPUTE);
+                        upload_zoom(config.zoom);
+                        set_prec(std::max(prec, config.center.get_prec()));
                     }
                 }
                 ImGui::SameLine();
@@ -2088,7 +4877,7 @@ public:
                     config.center = Config().center;
                     config.zoom = Config().zoom;
                     glUniform2d(glGetUniformLocation(shaderProgram, "center"), config.center.real(), config.center.imag());
-                    glUniform1d(glGetUniformLocation(shaderProgram, "zoom"), config.zoom);
+                    upload_zoom(config.zoom);
                     glUniform1f(glGetUniformLocation(shaderProgram, "theta"), config.theta * M_PI / 180.f);
                     set_op(MV_COMPUTE);
                 }
@@ -2099,9 +4888,33 @@ public:
                 if (ImGui::DragInt("Maximum iterations", &config.max_iters, abs(config.max_iters) / 20.f, 10, INT_MAX, "%d", ImGuiSliderFlags_AlwaysClamp)) {
                     glUniform1i(glGetUniformLocation(shaderProgram, "max_iters"), config.max_iters);
                     set_op(MV_COMPUTE);
+                    // only the pixels that reached the old limit can change
+                    resume_requested = true;
                 }
+                if (ImGui::DragInt("Frame budget", &config.frame_budget, 1.f, 0, 1000, "%d ms", ImGuiSliderFlags_AlwaysClamp))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Time spent computing per frame, slower views fill in over several frames. 0 computes whole frames");
+                if (ImGui::Checkbox("Compute kernel", &config.compute_kernel))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Iterates with a fixed number of workgroups that take pixels off a queue, instead of drawing the tiles");
+                ImGui::SameLine();
+                ImGui::BeginDisabled(!config.compute_kernel);
+                if (ImGui::Checkbox("Group by cost", &config.cost_ordering))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Queues the pixels of each tile by the iterations they took last time");
+                ImGui::EndDisabled();
+                ImGui::SameLine();
+                ImGui::TextDisabled("(last pass %.1f ms)", last_pass_time);
+                if (ImGui::Checkbox("Continue unfinished pixels", &config.resume_iterations))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Raising the iteration limit only carries on the pixels that reached it. Keeps 80 bytes per pixel");
+                ImGui::BeginDisabled(!config.resume_iterations);
+                if (ImGui::DragInt("Iterations per pass", &config.iteration_chunk, abs(config.iteration_chunk) / 20.f + 1.f, 0, INT_MAX, "%d", ImGuiSliderFlags_AlwaysClamp))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Spreads a large iteration limit over several passes, 0 reaches it in one");
+                ImGui::EndDisabled();
                 
-                ImGui::BeginDisabled(fractal != 2 || config.power != 2.f);
+                ImGui::BeginDisabled(!perturbation_available());
                 if (ImGui::Checkbox("Perturbation", &config.perturbation)) {
                     glUniform1i(glGetUniformLocation(shaderProgram, "perturbation"), config.perturbation);
                     set_op(MV_COMPUTE);
@@ -2109,15 +4922,18 @@ public:
                 ImGui::EndDisabled();
                 ImGui::SameLine();
                 ImGui::BeginDisabled(!config.perturbation);
-                ImGui::SetNextItemWidth(50);
                 static int min_prec = 6;
                 static int p2 = 8;
                 auto update_prec = [&]() {
-                    prec = pow(2, p2);
-                    config.center.change_prec(prec);
-                    glUniform2d(glGetUniformLocation(shaderProgram, "center"), config.center.real(), config.center.imag());
-                    set_op(MV_COMPUTE);
+                    set_prec(pow(2, p2));
                 };
+                if (ImGui::Checkbox("Auto", &config.auto_prec) && !config.auto_prec) {
+                    // pinning keeps the current value, the slider continues from the nearest power of two
+                    p2 = std::max(min_prec, static_cast<int>(round(log2(prec))));
+                }
+                ImGui::SameLine();
+                ImGui::BeginDisabled(config.auto_prec);
+                ImGui::SetNextItemWidth(50);
                 if (ImGui::DragScalar("##prec", ImGuiDataType_S32, &p2, 0.05f, &min_prec, nullptr, std::format("{}", prec).c_str(), ImGuiSliderFlags_AlwaysClamp)) {
                     update_prec();
                 }
@@ -2131,19 +4947,125 @@ public:
                     p2 += 1;
                     update_prec();
                 }
+                ImGui::EndDisabled();
                 ImGui::SameLine();
                 ImGui::Text("Precision");
+                if (config.perturbation && ref_worker.working()) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(computing orbit)");
+                }
+                if (ImGui::IsItemHovered()) {
+                    // stays put while the orbit is extended or the view moves, only new precisions and new threads allocate
+                    ImGui::SetTooltip("%llu multiprecision allocations so far", static_cast<unsigned long long>(MPAllocations::count.load()));
+                }
+
+                if (ImGui::Checkbox("Rebasing", &config.rebasing)) {
+                    glUniform1i(glGetUniformLocation(shaderProgram, "rebasing"), config.rebasing);
+                    set_op(MV_COMPUTE);
+                }
+                ImGui::SameLine();
+                if (ImGui::Checkbox("Glitch correction", &config.glitch_correction)) {
+                    glUniform1i(glGetUniformLocation(shaderProgram, "glitch_detection"), config.glitch_correction);
+                    set_op(MV_COMPUTE);
+                }
+                ImGui::SameLine();
+                ImGui::BeginDisabled(!config.glitch_correction);
+                ImGui::SetNextItemWidth(80);
+                if (ImGui::InputInt("Max references", &config.max_references)) {
+                    config.max_references = std::max(config.max_references, 0);
+                    set_op(MV_COMPUTE);
+                }
+                ImGui::EndDisabled();
+                if (config.perturbation && config.glitch_correction && (glitch_references > 0 || glitched_pixels > 0)) {
+                    ImGui::TextDisabled("%d extra reference%s, %d glitched pixel%s left", glitch_references, glitch_references == 1 ? "" : "s", glitched_pixels, glitched_pixels == 1 ? "" : "s");
+                }
+
+                // the one period orbit ends at 0, pixels continue by rebasing to its start
+                ImGui::BeginDisabled(!config.rebasing || !orbit_formula().quadratic());
+                if (ImGui::Checkbox("Reference at nucleus", &config.nucleus_reference)) {
+                    set_op(MV_COMPUTE);
+                }
+                if (config.nucleus_reference && ref_orbit.period > 0) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(period %d)", ref_orbit.period);
+                }
+                ImGui::EndDisabled();
+                ImGui::Checkbox("Cache orbits on disk", &config.orbit_cache);
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Orbits that take longer than %.1f s to compute are kept in %s", orbit_cache_min_seconds, orbit_cache_directory().string().c_str());
+                }
 
+                ImGui::BeginDisabled(config.normal_map_effect);
                 if (ImGui::Checkbox("Series approximation", &config.series_approx)) {
                     glUniform1i(glGetUniformLocation(shaderProgram, "series_approx"), config.series_approx);
+                    set_op(MV_COMPUTE);
+                }
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(80);
+                if (ImGui::SliderInt("Terms", &config.num_terms, 2, 16, "%d", ImGuiSliderFlags_AlwaysClamp)) {
+                    set_op(MV_COMPUTE);
+                }
+                if (config.series_approx && series.skip > 1) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(skipping %d iterations)", series.skip);
+                }
+                if (ImGui::Checkbox("Linear approximation (BLA)", &config.bla)) {
+                    set_op(MV_COMPUTE);
+                }
+                if (ImGui::Checkbox("Compress orbit", &config.compress_orbit)) {
+                    set_op(MV_COMPUTE);
+                }
+                if (reforbit_size > 0) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(%d iterations, %.1f MB, %.1fx)", reforbit_size, ref_orbit.bytes() / 1048576.0, ref_orbit.compression_ratio());
                 }
                 ImGui::EndDisabled();
+                ImGui::EndDisabled();
 
                 ImGui::BeginDisabled(fractal != 2 || config.power != 2.f);
                 if (ImGui::Checkbox("Cardioid/bulb skipping", &config.cardioid_check)) {
                     glUniform1i(glGetUniformLocation(shaderProgram, "cardioid_check"), config.cardioid_check);
                 }
                 ImGui::EndDisabled();
+                ImGui::SameLine();
+                ImGui::BeginDisabled(!escape_bailout(fractals[fractal].condition));
+                if (ImGui::Checkbox("Periodicity checking", &config.periodicity_check)) {
+                    glUniform1i(glGetUniformLocation(shaderProgram, "periodicity"), config.periodicity_check && escape_bailout(fractals[fractal].condition));
+                    set_op(MV_COMPUTE);
+                }
+                ImGui::SetItemTooltip("Stops at orbits that repeat, they would run to the iteration limit. Only for bailouts that wait for Z to grow");
+                if (ImGui::Checkbox("Boundary subdivision", &config.subdivision))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Fills blocks whose border is entirely in the set without iterating them. Only for bailouts that wait for Z to grow");
+                ImGui::EndDisabled();
+
+                ImGui::BeginDisabled(config.perturbation);
+                if (ImGui::Checkbox("Single precision at shallow zooms", &config.single_precision))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Iterates in floats while the view is shallow enough for them, which most GPUs run many times faster than doubles");
+                if (single_pass) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(in use)");
+                }
+                if (ImGui::Checkbox("Emulated double precision", &config.emulated_double))
+                    set_op(MV_COMPUTE);
+                ImGui::SetItemTooltip("Iterates in pairs of floats instead of doubles, about 48 bits instead of 53. Faster on GPUs that are slow at doubles, which is most consumer ones");
+                if (emulated_pass) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(in use)");
+                }
+                else if (config.emulated_double && !emulated_available) {
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(not supported by the equation)");
+                }
+                ImGui::Text("Bailout checks:");
+                ImGui::SetItemTooltip("Iterates in batches and only checks the bailout after each one, the image stays the same. Not used with perturbation");
+                for (int size : {0, 8, 16}) {
+                    ImGui::SameLine();
+                    if (ImGui::RadioButton(size ? std::format("Every {}", size).c_str() : "Every iteration", &config.batch_size, size))
+                        glUniform1i(glGetUniformLocation(shaderProgram, "batch_size"), config.batch_size);
+                }
+                ImGui::EndDisabled();
 
                 ImGui::Dummy(ImVec2(0.f, 5.f));
                 ImGui::SeparatorText("Fractal");
@@ -2186,7 +5108,6 @@ public:
                                 config.vflip = fractals[n].vflip;
                                 always_refresh_main = false;
                                 if (n != 2) {
-                                    config.perturbation = false;
                                     config.series_approx = false;
                                     config.cardioid_check = false;
                                 }
@@ -2404,6 +5325,9 @@ public:
                                     glBindTexture(GL_TEXTURE_2D, accIndexTexBuffer);
                                     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, config.frameSize.x * config.ssaa, config.frameSize.y * config.ssaa, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
 
+                                    glBindTexture(GL_TEXTURE_2D, glitchMaskTexBuffer);
+                                    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, fs.x * config.ssaa, fs.y * config.ssaa, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+
                                     upload_kernel(config.ssaa);
                                     set_op(MV_COMPUTE);
                                 }
@@ -2702,21 +5626,94 @@ public:
             glUniform1f(glGetUniformLocation(shaderProgram, "time"), currentTime);
 
             if (config.perturbation) {
-                std::vector<dvec2> orbit;
-                MPC c = config.center;
-                MPC z = c;
-                for (int i = 0; i < config.max_iters; i++) {
-                    orbit.push_back(z);
-                    z = z * z + c;
-                    double x = z.real();
-                    double y = z.imag();
-                    if (x * x + y * y > 100.0) {
-                        break;
+                const floatexp& zoom = (recording ? zvc.tcfg.zoom : config.zoom);
+                const MPC& center = (recording ? zvc.tcfg.center : config.center);
+                int max_iters = (recording ? zvc.tcfg.max_iters : config.max_iters);
+                if (fractals[fractal].reference == ReferenceFormula::Julia) {
+                    // the sliders reach the shader as floats. moving them replaces the exact constant of a double click
+                    const auto& sliders = fractals[fractal].sliders;
+                    dvec2 shown(static_cast<float>(sliders[0].value), static_cast<float>(sliders[1].value));
+                    if (dvec2(vec2(dvec2(julia_constant))) != shown) julia_constant = shown;
+                }
+                OrbitFormula formula = orbit_formula();
+                // deltas that small no longer survive being squared as doubles. the floatexp path only knows Z^2 + C,
+                // other formulas stay in doubles and lose accuracy past ~1e-300
+                bool use_floatexp = zoom < floatexp_threshold && formula.quadratic();
+                glUniform1i(glGetUniformLocation(shaderProgram, "use_floatexp"), use_floatexp);
+
+                // distance from the center to the corners of the frame
+                ivec2 size = (recording ? zvc.tcfg.frameSize : fs);
+                if (config.auto_prec) {
+                    mpfr_prec_t p = required_precision(zoom, size.x * (recording ? zvc.tcfg.ssaa : config.ssaa));
+                    if (p != prec) set_prec(p);
+                }
+                floatexp view_extent = zoom * (0.5 * sqrt(1.0 + pow(static_cast<double>(size.y) / size.x, 2)));
+                double view_radius = view_extent.to_double();
+                // rounded up to a power of two so the approximations aren't rebuilt on every zoom step
+                double approx_radius = exp2(ceil(log2(view_radius)));
+                bool use_series = config.series_approx && !config.normal_map_effect && !use_floatexp && formula.quadratic();
+                bool use_bla = config.bla && !config.normal_map_effect && !use_floatexp && formula.quadratic();
+                bool use_nucleus = config.nucleus_reference && config.rebasing && formula.quadratic();
+                // the same for the nucleus search, which is also part of its cache key
+                floatexp nucleus_radius = use_nucleus ? floatexp::exp2(ceil(view_extent.log2())) : floatexp(0.0);
+                ref_worker.request(center, reference_precision(formula), max_iters, formula, julia_constant, use_series ? config.num_terms : 0, approx_radius, use_bla, config.compress_orbit, nucleus_radius, config.orbit_cache);
+                bool restore = reference_uniforms_stale;
+                reference_uniforms_stale = false;
+                bool resumable = resume_requested, extended = false;
+                if (ref_worker.poll(ref_orbit, ref_center, extended)) {
+                    if (ref_orbit.compressed) {
+                        glBindBuffer(GL_SHADER_STORAGE_BUFFER, waypointBuffer);
+                        glBufferData(GL_SHADER_STORAGE_BUFFER, ref_orbit.waypoints.size() * sizeof(Waypoint), ref_orbit.waypoints.data(), GL_DYNAMIC_COPY);
+                        // the full orbit isn't needed anymore
+                        glBindBuffer(GL_SHADER_STORAGE_BUFFER, referenceBuffer);
+                        glBufferData(GL_SHADER_STORAGE_BUFFER, 0, nullptr, GL_DYNAMIC_COPY);
+                    }
+                    else {
+                        glBindBuffer(GL_SHADER_STORAGE_BUFFER, referenceBackBuffer);
+                        glBufferData(GL_SHADER_STORAGE_BUFFER, ref_orbit.orbit.size() * sizeof(dvec2), ref_orbit.orbit.data(), GL_DYNAMIC_COPY);
+                        std::swap(referenceBuffer, referenceBackBuffer);
+                        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, referenceBuffer);
                     }
+                    restore = true;
+                }
+                // the orbit of another fractal is of no use, pixels are iterated directly until the right one arrives
+                int usable_size = ref_orbit.formula == formula ? ref_orbit.length : 0;
+                if (restore || usable_size != reforbit_size) {
+                    glUniform1i(glGetUniformLocation(shaderProgram, "ref_compressed"), ref_orbit.compressed);
+                    glUniform1i(glGetUniformLocation(shaderProgram, "num_waypoints"), ref_orbit.waypoints.size());
+                    glUniform2d(glGetUniformLocation(shaderProgram, "ref_c"), ref_orbit.c.x, ref_orbit.c.y);
+                    glUniform1i(glGetUniformLocation(shaderProgram, "ref_start"), ref_orbit.formula.start());
+                    reforbit_size = usable_size;
+                    glUniform1i(glGetUniformLocation(shaderProgram, "reforbit_size"), reforbit_size);
+                    set_op(MV_COMPUTE);
+                }
+                // until the orbit for the new center arrives, keep rendering relative to the old one
+                dvec2 ref_offset = scaled_difference(center, ref_center, 0);
+                upload_ref_offset(center, ref_center, zoom);
+
+                if (ref_worker.poll_series(series) || restore) {
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, coeffBuffer);
+                    glBufferData(GL_SHADER_STORAGE_BUFFER, series.coefficients.size() * sizeof(dvec2), series.coefficients.data(), GL_DYNAMIC_COPY);
+                    glUniform1i(glGetUniformLocation(shaderProgram, "sa_terms"), series.coefficients.size());
+                    glUniform1d(glGetUniformLocation(shaderProgram, "sa_radius"), series.radius);
+                    set_op(MV_COMPUTE);
+                }
+                // the coefficients are only valid for pixels within the radius they were computed for
+                bool series_valid = use_series && series.skip > 1 && series.skip < reforbit_size && view_radius + length(ref_offset) <= series.radius;
+                sa_skip = series_valid ? series.skip : 0;
+                glUniform1i(glGetUniformLocation(shaderProgram, "sa_skip"), sa_skip);
+
+                if (ref_worker.poll_bla(bla_table) || restore) {
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, blaBuffer);
+                    glBufferData(GL_SHADER_STORAGE_BUFFER, bla_table.entries.size() * sizeof(BLA), bla_table.entries.data(), GL_DYNAMIC_COPY);
+                    glUniform1iv(glGetUniformLocation(shaderProgram, "bla_offsets"), bla_table.offsets.size(), bla_table.offsets.data());
+                    set_op(MV_COMPUTE);
                 }
-                glBindBuffer(GL_SHADER_STORAGE_BUFFER, referenceBuffer);
-                glBufferData(GL_SHADER_STORAGE_BUFFER, orbit.size() * sizeof(dvec2), orbit.data(), GL_DYNAMIC_COPY);
-                glUniform1i(glGetUniformLocation(shaderProgram, "reforbit_size"), orbit.size());
+                bool bla_valid = use_bla && bla_table.offsets.size() > 1 && view_radius + length(ref_offset) <= bla_table.radius;
+                bla_levels = bla_valid ? bla_table.offsets.size() - 1 : 0;
+                glUniform1i(glGetUniformLocation(shaderProgram, "bla_levels"), bla_levels);
+                // an orbit that only got longer has the same start, the pixels stopped against it carry on with the rest
+                if (extended && resumable) resume_requested = true;
             }
 
             glActiveTexture(GL_TEXTURE0);
@@ -2726,14 +5723,90 @@ public:
             glActiveTexture(GL_TEXTURE3);
             glBindTexture(GL_TEXTURE_2D, prevFrameTexBuffer);
 
-            switch (op) {
-            case MV_COMPUTE:
+            // a higher iteration limit needs a longer orbit first, the pass waits for it instead of resuming against the short
+            // one and starting over once it arrives
+            bool awaiting_orbit = op == MV_COMPUTE && tiles_stale && resume_requested && state_iters > 0 && config.perturbation && ref_worker.working();
+            switch (awaiting_orbit ? MV_RENDER : op) {
+            case MV_COMPUTE: {
                 glBindFramebuffer(GL_FRAMEBUFFER, computeFrameBuffer);
                 glUniform1i(glGetUniformLocation(shaderProgram, "op"), MV_COMPUTE);
-                glDrawArrays(GL_TRIANGLES, 0, 6);
-                if (persist_orbit)
-                    copy_orbit_buffer();
+                if (tiles_stale) {
+                    tiles_stale = false;
+                    if (config.perturbation && config.glitch_correction) {
+                        unsigned int zero = 0;
+                        glClearTexImage(glitchMaskTexBuffer, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+                    }
+                    // video frames have to be complete, and taa accumulates a whole frame per sample
+                    bool whole = recording || config.taa || config.frame_budget <= 0;
+                    ivec2 size = recording ? zvc.tcfg.frameSize * zvc.tcfg.ssaa : fs * config.ssaa;
+
+                    // taa moves the samples every frame, there is nothing to carry on from
+                    storing_state = config.resume_iterations && !config.taa && !recording;
+                    size_t state_size = storing_state ? static_cast<size_t>(size.x) * size.y * pixel_state_size : 0;
+                    if (state_size != state_buffer_size) {
+                        glBindBuffer(GL_SHADER_STORAGE_BUFFER, stateBuffer);
+                        glBufferData(GL_SHADER_STORAGE_BUFFER, state_size, nullptr, GL_DYNAMIC_COPY);
+                        state_buffer_size = state_size;
+                        state_iters = 0;
+                    }
+                    bool resume = storing_state && resume_requested && state_iters > 0 && state_iters < config.max_iters;
+                    pass_limit = recording ? zvc.tcfg.max_iters : config.max_iters;
+                    if (storing_state && config.iteration_chunk > 0)
+                        pass_limit = static_cast<int>(std::min<int64_t>(pass_limit, static_cast<int64_t>(resume ? state_iters : 0) + config.iteration_chunk));
+                    // until this pass is complete the stored pixels are a mix of two
+                    state_iters = 0;
+                    resume_requested = false;
+                    // a resumed pass only visits the pixels that are left, and taa samples move around within the pixels
+                    if (config.compute_kernel && kernel_stale) {
+                        build_kernel();
+                        kernel_stale = false;
+                    }
+                    kernel_pass = config.compute_kernel && kernelProgram;
+                    // the kernel has no barrier between the lines the subdivision computes one after another
+                    subdividing = config.subdivision && !resume && !config.taa && !kernel_pass && escape_bailout(fractals[fractal].condition);
+                    glUniform1i(glGetUniformLocation(shaderProgram, "resume"), resume);
+                    glUniform1i(glGetUniformLocation(shaderProgram, "store_state"), storing_state);
+                    glUniform1i(glGetUniformLocation(shaderProgram, "iter_limit"), pass_limit);
+                    dvec2 focus = dvec2(size) * 0.5;
+                    double x, y;
+                    glfwGetCursorPos(window, &x, &y);
+                    dvec2 cursor = dvec2(x * dpi_scale, fs.y - y * dpi_scale) * static_cast<double>(config.ssaa);
+                    if (zoomTowards == 1 && !recording && cursor.x >= 0 && cursor.y >= 0 && cursor.x < size.x && cursor.y < size.y)
+                        focus = cursor;
+                    // floats are enough while neighbouring pixels are a few hundred of their ulps apart
+                    double view_zoom = static_cast<double>(recording ? zvc.tcfg.zoom : config.zoom);
+                    dvec2 view_center = recording ? zvc.tcfg.center : config.center;
+                    single_pass = config.single_precision && single_available && !config.perturbation && !storing_state &&
+                        view_zoom / size.x > single_spacing * std::max(1.0, length(view_center) + view_zoom);
+                    glUniform1i(glGetUniformLocation(shaderProgram, "single_precision"), single_pass);
+                    emulated_pass = config.emulated_double && emulated_available && !single_pass && !config.perturbation && !storing_state;
+                    glUniform1i(glGetUniformLocation(shaderProgram, "emulated_double"), emulated_pass);
+                    plan_compute_tiles(size, focus, whole);
+                    if (kernel_pass) queue_compute_tiles(size);
+                    pass_time = 0.0;
+                }
+                if (glitch_pixel.x >= 0)
+                    correct_glitches(recording ? zvc.tcfg : config, recording);
+                else if (draw_compute_tiles(config.frame_budget)) {
+                    // fixing glitches against a stale reference would only be thrown away once the new one arrives
+                    if (config.perturbation && config.glitch_correction && !ref_worker.working()) {
+                        glitch_references = 0;
+                        next_glitch(recording ? zvc.tcfg : config);
+                        correct_glitches(recording ? zvc.tcfg : config, recording);
+                    }
+                    if (persist_orbit)
+                        copy_orbit_buffer();
+                    if (storing_state) {
+                        state_iters = pass_limit;
+                        // the next part of an iteration count spread over several passes
+                        if (pass_limit < config.max_iters) {
+                            set_op(MV_COMPUTE);
+                            resume_requested = true;
+                        }
+                    }
+                }
                 [[fallthrough]];
+            }
             case MV_POSTPROC:
                 glBindFramebuffer(GL_FRAMEBUFFER, postprocFrameBuffer);
                 glUniform1i(glGetUniformLocation(shaderProgram, "op"), MV_POSTPROC);
@@ -2766,6 +5839,9 @@ public:
                     set_op(MV_RENDER, true);
                 }
             }
+            // the tiles that didn't fit in the budget are drawn in the next frames, like the next part of a long count, and
+            // so are the glitches whose secondary reference is still being computed
+            if (next_tile < compute_tiles.size() || tiles_stale || glitch_pixel.x >= 0) op = MV_COMPUTE;
 
             glCopyImageSubData(
                 postprocTexBuffer, GL_TEXTURE_2D, 0, 0, 0, 0,
@@ -2786,6 +5862,17 @@ public:
                 orbit_refreshed = false;
             }
 
+            AutoNavigator::Target target;
+            while (navigator.poll(target)) {
+                if (target_folder.empty()) {
+                    zvc.tcfg.center = target.center;
+                    zvc.end_zoom = target.zoom;
+                    // minibrots only show their shape with many times their period
+                    zvc.tcfg.max_iters = std::max(zvc.tcfg.max_iters, target.period * 16);
+                }
+                else save_location(target_folder / std::format("MV2 target {} period {}.mvl", target.seed, target.period), target.center, target.zoom);
+            }
+
             if (recording && !paused) {
                 if (progress > 0) {
                     writeFrame(writer, postprocTexBuffer);
@@ -2803,13 +5890,13 @@ public:
                     double x = static_cast<double>(progress) / framecount;
                     double z = 3 * pow(x, 2) - 2 * pow(x, 3);
                     if (zvc.direction == 1) z = -z + 1;
-                    double coeff = pow(config.zoom / 5.0, 1.0 / framecount);
+                    floatexp target = zvc.end_zoom / 5.0;
                     if (zvc.ease_inout)
-                        zvc.tcfg.zoom = 8.0 * pow(coeff, z * framecount);
+                        zvc.tcfg.zoom = pow(target, z) * 8.0;
                     else
-                        zvc.tcfg.zoom = 8.0 * pow(coeff, progress);
+                        zvc.tcfg.zoom = pow(target, x) * 8.0;
                     glUniform1i(glGetUniformLocation(shaderProgram, "max_iters"),zvc.tcfg.max_iters);
-                    glUniform1d(glGetUniformLocation(shaderProgram, "zoom"), zvc.tcfg.zoom);
+                    upload_zoom(zvc.tcfg.zoom);
                 }
                 set_op(MV_COMPUTE, true);
             }
@@ -2822,6 +5909,7 @@ public:
 };
 
 int main() {
+    MPAllocations::install();
     MV2 app;
     app.mainloop();
 